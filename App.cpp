@@ -12,6 +12,7 @@
 
 #include "App.h"
 #include "Constants.h"
+#include "Scripting.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "Application"
@@ -67,6 +68,31 @@ App::AboutRequested()
 }
 
 
+BHandler*
+App::ResolveSpecifier(BMessage* message, int32 index, BMessage* specifier,
+	int32 what, const char* property)
+{
+	// the window keeps the history, it answers for itself
+	BPropertyInfo propertyInfo(kScriptingProperties);
+	if (fMainWindow != NULL && propertyInfo.FindMatch(message, index,
+			specifier, what, property) >= 0)
+		return fMainWindow;
+
+	return BApplication::ResolveSpecifier(message, index, specifier, what,
+		property);
+}
+
+
+status_t
+App::GetSupportedSuites(BMessage* data)
+{
+	data->AddString("suites", kScriptingSuite);
+	BPropertyInfo propertyInfo(kScriptingProperties);
+	data->AddFlat("messages", &propertyInfo);
+	return BApplication::GetSupportedSuites(data);
+}
+
+
 int
 main()
 {
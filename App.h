@@ -14,6 +14,7 @@
 #include <TextView.h>
 
 #include "ClipdingerSettings.h"
+#include "IconCache.h"
 #include "MainWindow.h"
 
 #define my_app dynamic_cast<App*>(be_app)
@@ -25,13 +26,19 @@ public:
 
 	virtual void		ReadyToRun();
 	void				AboutRequested();
+	virtual BHandler*	ResolveSpecifier(BMessage* message, int32 index,
+							BMessage* specifier, int32 what,
+							const char* property);
+	virtual status_t	GetSupportedSuites(BMessage* data);
 
 	ClipdingerSettings* Settings() { return &fSettings; }
+	IconCache*			Icons() { return &fIcons; }
 
 	MainWindow*			fMainWindow;
 
 private:
 	ClipdingerSettings	fSettings;
+	IconCache			fIcons;
 };
 
 #endif	// APP_H
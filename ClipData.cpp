@@ -0,0 +1,307 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <Entry.h>
+#include <File.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "ClipData.h"
+#include "Constants.h"
+#include "HistoryFile.h"
+
+
+ClipData::ClipData(const char* data, size_t length)
+	:
+	fData(NULL),
+	fStoredLength(0),
+	fLength(0),
+	fCompressed(false),
+	fBuffer(NULL),
+	fFile(NULL)
+{
+	MakeDigest(data, length, fDigest);
+	_Store(data, length);
+}
+
+
+ClipData::ClipData(const char* data, size_t length, const clip_digest& digest)
+	:
+	fData(NULL),
+	fStoredLength(0),
+	fLength(0),
+	fCompressed(false),
+	fBuffer(NULL),
+	fFile(NULL),
+	fDigest(digest)
+{
+	_Store(data, length);
+}
+
+
+ClipData::ClipData(const char* stored, size_t storedLength, size_t length,
+	bool compressed, const clip_digest& digest)
+	:
+	fData(NULL),
+	fStoredLength(0),
+	fLength(0),
+	fCompressed(false),
+	fBuffer(NULL),
+	fFile(NULL),
+	fDigest(digest)
+{
+	_Copy(stored, storedLength);
+	fLength = length;
+	fCompressed = compressed;
+}
+
+
+ClipData::ClipData(HistoryFile* file, const char* stored, size_t storedLength,
+	size_t length, bool compressed, const clip_digest& digest)
+	:
+	fData(stored),
+	fStoredLength(storedLength),
+	fLength(length),
+	fCompressed(compressed),
+	fBuffer(NULL),
+	fFile(file),
+	fDigest(digest)
+{
+	fFile->AcquireReference();
+}
+
+
+ClipData::ClipData(const BPath& spillPath, size_t length,
+	const clip_digest& digest)
+	:
+	fData(NULL),
+	fStoredLength(0),
+	fLength(length),
+	fCompressed(false),
+	fBuffer(NULL),
+	fFile(NULL),
+	fSpillPath(spillPath),
+	fDigest(digest)
+{
+}
+
+
+ClipData::~ClipData()
+{
+	free(fBuffer);
+	if (fFile != NULL)
+		fFile->ReleaseReference();
+}
+
+
+status_t
+ClipData::InitCheck() const
+{
+	return fData != NULL || IsSpilled() ? B_OK : B_NO_MEMORY;
+}
+
+
+BString
+ClipData::Text() const
+{
+	if (!fCompressed && !IsSpilled())
+		return BString(fData, fLength);
+
+	BString text;
+	char* buffer = text.LockBuffer(fLength);
+	if (buffer == NULL)
+		return text;
+	size_t length = IsSpilled() ? _ReadSpilled(buffer, fLength)
+		: _Inflate(buffer, fLength);
+	text.UnlockBuffer(length);
+	return text;
+}
+
+
+const char*
+ClipData::GetText(BString& buffer, size_t& length) const
+{
+	if (!fCompressed && !IsSpilled()) {
+		length = fLength;
+		return fData;
+	}
+
+	buffer = Text();
+	length = buffer.Length();
+	return buffer.String();
+}
+
+
+void
+ClipData::GetTitle(BString& title) const
+{
+	if (!fCompressed && !IsSpilled()) {
+		MakeTitle(fData, fLength, title);
+		return;
+	}
+
+	// a UTF-8 character takes up to four bytes
+	char buffer[kMaxTitleChars * 4];
+	size_t length = IsSpilled() ? _ReadSpilled(buffer, sizeof(buffer))
+		: _Inflate(buffer, sizeof(buffer));
+	MakeTitle(buffer, length, title);
+}
+
+
+/*static*/ void
+ClipData::MakeTitle(const char* data, size_t length, BString& title)
+{
+	// only the first kMaxTitleChars characters can ever be shown
+	size_t end = 0;
+	int32 chars = 0;
+	while (end < length) {
+		if ((data[end] & 0xc0) != 0x80 && ++chars > kMaxTitleChars)
+			break;
+		end++;
+	}
+
+	// a title is a single line: runs of line breaks and tabs become a space
+	char* buffer = title.LockBuffer(end);
+	if (buffer == NULL) {
+		title.SetTo(data, end);
+		return;
+	}
+	size_t titleLength = 0;
+	for (size_t i = 0; i < end; i++) {
+		char c = data[i];
+		if (c == '\n' || c == '\r' || c == '\t') {
+			if (titleLength > 0 && buffer[titleLength - 1] == ' ')
+				continue;
+			c = ' ';
+		}
+		buffer[titleLength++] = c;
+	}
+	title.UnlockBuffer(titleLength);
+}
+
+
+/*static*/ void
+ClipData::MakeDigest(const char* data, size_t length, clip_digest& digest)
+{
+	SHA256::Digest(data, length, digest.bytes);
+}
+
+
+/*static*/ status_t
+ClipData::WriteSpillFile(const BPath& path, const char* data, size_t length)
+{
+	BString tempPath(path.Path());
+	tempPath.Append("~");
+
+	BFile file(tempPath.String(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	status_t status = file.InitCheck();
+	while (status == B_OK && length > 0) {
+		// write in chunks, so a huge clip doesn't need one huge write
+		size_t chunk = length < 1024 * 1024 ? length : 1024 * 1024;
+		ssize_t written = file.Write(data, chunk);
+		if (written < 0)
+			status = written;
+		else if (written == 0)
+			status = B_IO_ERROR;
+		else {
+			data += written;
+			length -= written;
+		}
+	}
+	// the journal may refer to the file as soon as it's renamed
+	if (status == B_OK)
+		status = file.Sync();
+	file.Unset();
+
+	BEntry entry(tempPath.String());
+	if (status == B_OK)
+		status = entry.Rename(path.Path(), true);
+	if (status != B_OK)
+		entry.Remove();
+	return status;
+}
+
+
+void
+ClipData::_Store(const char* data, size_t length)
+{
+	if (length < kCompressThreshold) {
+		_Copy(data, length);
+		return;
+	}
+
+	uLongf size = compressBound(length);
+	fBuffer = (char*)malloc(size);
+	if (fBuffer != NULL
+		&& compress2((Bytef*)fBuffer, &size, (const Bytef*)data, length,
+			Z_BEST_SPEED) == Z_OK
+		&& size < length - length / 8) {
+		// give back what the worst case estimate didn't need
+		char* buffer = (char*)realloc(fBuffer, size);
+		if (buffer != NULL)
+			fBuffer = buffer;
+		fData = fBuffer;
+		fStoredLength = size;
+		fLength = length;
+		fCompressed = true;
+		return;
+	}
+
+	// not worth it
+	free(fBuffer);
+	fBuffer = NULL;
+	_Copy(data, length);
+}
+
+
+void
+ClipData::_Copy(const char* data, size_t length)
+{
+	fBuffer = (char*)malloc(length + 1);
+	if (fBuffer == NULL)
+		return;
+
+	memcpy(fBuffer, data, length);
+	fBuffer[length] = '\0';
+	fData = fBuffer;
+	fStoredLength = length;
+	fLength = length;
+}
+
+
+// Inflates the start of the text into the buffer, returns the number of
+// bytes that could be inflated.
+size_t
+ClipData::_Inflate(char* buffer, size_t size) const
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit(&stream) != Z_OK)
+		return 0;
+
+	stream.next_in = (Bytef*)fData;
+	stream.avail_in = fStoredLength;
+	stream.next_out = (Bytef*)buffer;
+	stream.avail_out = size;
+	inflate(&stream, Z_SYNC_FLUSH);
+
+	size_t length = size - stream.avail_out;
+	inflateEnd(&stream);
+	return length;
+}
+
+
+size_t
+ClipData::_ReadSpilled(char* buffer, size_t size) const
+{
+	BFile file(fSpillPath.Path(), B_READ_ONLY);
+	ssize_t bytes = file.Read(buffer, size);
+	return bytes > 0 ? bytes : 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef CLIPDATA_H
+#define CLIPDATA_H
+
+#include <Path.h>
+#include <Referenceable.h>
+#include <String.h>
+
+#include <string.h>
+
+#include "SHA256.h"
+
+class HistoryFile;
+
+
+struct clip_digest {
+	uint8				bytes[kSHA256DigestSize];
+
+	bool operator<(const clip_digest& other) const
+		{ return memcmp(bytes, other.bytes, sizeof(bytes)) < 0; }
+	bool operator==(const clip_digest& other) const
+		{ return memcmp(bytes, other.bytes, sizeof(bytes)) == 0; }
+};
+
+
+// The immutable text of a clip, identified by the SHA-256 of its contents.
+// It either lives in its own buffer or directly in the memory mapped
+// history file, in which case the pages are only touched when the text
+// is actually used.
+// Texts of kCompressThreshold bytes and more are kept zlib compressed,
+// in memory and on disk, and are only inflated when the text is needed.
+// Really large texts are spilled to a file of their own and only read
+// back when they're pasted.
+class ClipData : public BReferenceable {
+public:
+						ClipData(const char* data, size_t length);
+						ClipData(const char* data, size_t length,
+							const clip_digest& digest);
+						ClipData(const char* stored, size_t storedLength,
+							size_t length, bool compressed,
+							const clip_digest& digest);
+						ClipData(HistoryFile* file, const char* stored,
+							size_t storedLength, size_t length,
+							bool compressed, const clip_digest& digest);
+						ClipData(const BPath& spillPath, size_t length,
+							const clip_digest& digest);
+	virtual				~ClipData();
+
+	status_t			InitCheck() const;
+
+	size_t				Length() const { return fLength; };
+	const clip_digest&	Digest() const { return fDigest; };
+	BString				Text() const;
+	// the text without a copy, unless it has to be unpacked into the buffer
+	const char*			GetText(BString& buffer, size_t& length) const;
+	void				GetTitle(BString& title) const;
+
+	// the text as it's kept in memory and written to disk
+	const char*			StoredData() const { return fData; };
+	size_t				StoredLength() const { return fStoredLength; };
+	bool				IsCompressed() const { return fCompressed; };
+	bool				IsSpilled() const
+							{ return fSpillPath.InitCheck() == B_OK; };
+	const char*			SpillPath() const { return fSpillPath.Path(); };
+
+	static void			MakeTitle(const char* data, size_t length,
+							BString& title);
+	static void			MakeDigest(const char* data, size_t length,
+							clip_digest& digest);
+	static status_t		WriteSpillFile(const BPath& path, const char* data,
+							size_t length);
+
+private:
+	void				_Store(const char* data, size_t length);
+	void				_Copy(const char* data, size_t length);
+	size_t				_Inflate(char* buffer, size_t size) const;
+	size_t				_ReadSpilled(char* buffer, size_t size) const;
+
+	const char*			fData;
+	size_t				fStoredLength;
+	size_t				fLength;
+	bool				fCompressed;
+	char*				fBuffer;
+	HistoryFile*		fFile;
+	BPath				fSpillPath;
+	clip_digest			fDigest;
+};
+
+#endif // CLIPDATA_H
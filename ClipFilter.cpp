@@ -0,0 +1,287 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "ClipFilter.h"
+#include "TextScan.h"
+
+static const int32 kNoMatch = -1;
+
+static const int32 kScoreMatch = 16;
+static const int32 kBonusBoundary = 10;		// at the start of a word
+static const int32 kBonusConsecutive = 8;	// right after the previous one
+static const int32 kPenaltyGapStart = 3;
+static const int32 kPenaltyGapExtension = 1;
+static const int32 kMaxLeadingPenalty = 10;
+// bytes of text around a match that are scored at most
+static const size_t kScoreWindow = 256;
+
+
+// UTF-8 characters are matched as a whole, only ASCII ignores the case
+
+static inline int32
+char_length(const char* c)
+{
+	uint8 byte = (uint8)*c;
+	if ((byte & 0xe0) == 0xc0)
+		return 2;
+	if ((byte & 0xf0) == 0xe0)
+		return 3;
+	if ((byte & 0xf8) == 0xf0)
+		return 4;
+	return 1;
+}
+
+
+static inline const char*
+next_char(const char* c)
+{
+	c++;
+	while (((uint8)*c & 0xc0) == 0x80)
+		c++;
+	return c;
+}
+
+
+static inline const char*
+previous_char(const char* start, const char* c)
+{
+	c--;
+	while (c > start && ((uint8)*c & 0xc0) == 0x80)
+		c--;
+	return c;
+}
+
+
+static inline bool
+char_matches(const char* text, const char* query, int32 length)
+{
+	if (length == 1)
+		return tolower((uint8)*text) == (uint8)*query;
+	return strncmp(text, query, length) == 0;
+}
+
+
+static inline bool
+is_boundary(char c)
+{
+	return (uint8)c < 0x80 && !isalnum((uint8)c);
+}
+
+
+static bool
+better_match(const filter_match& a, const filter_match& b)
+{
+	if (a.score != b.score)
+		return a.score > b.score;
+	return a.order < b.order;
+}
+
+
+//	#pragma mark -
+
+
+ClipFilter::ClipFilter(filter_text_func textOf, filter_title_func titleOf)
+	:
+	fTextOf(textOf),
+	fTitleOf(titleOf)
+{
+}
+
+
+ClipFilter::~ClipFilter()
+{
+	Reset();
+}
+
+
+void
+ClipFilter::Reset()
+{
+	for (size_t i = 0; i < fLevels.size(); i++)
+		delete fLevels[i];
+	fLevels.clear();
+}
+
+
+// Puts the best of the items matching the query into results, best first.
+void
+ClipFilter::Filter(const char* query, const ListModel& items, BList& results,
+	int32 maxResults)
+{
+	BString folded(query);
+	folded.ToLower();
+
+	// earlier queries this one doesn't extend are of no use anymore
+	while (!fLevels.empty() && strncmp(folded.String(),
+			fLevels.back()->query.String(),
+			fLevels.back()->query.Length()) != 0) {
+		delete fLevels.back();
+		fLevels.pop_back();
+	}
+
+	if (fLevels.empty() || fLevels.back()->query != folded) {
+		filter_level* level = new filter_level;
+		level->query = folded;
+
+		if (fLevels.empty()) {
+			for (int32 i = 0; i < items.CountItems(); i++) {
+				BListItem* item = items.ItemAt(i);
+				int32 score = _Score(item, folded);
+				if (score == kNoMatch)
+					continue;
+
+				filter_match match = { item, score, i };
+				level->matches.push_back(match);
+			}
+		} else {
+			// what didn't match before can't match with more characters
+			const std::vector<filter_match>& previous
+				= fLevels.back()->matches;
+			level->matches.reserve(previous.size());
+			for (size_t i = 0; i < previous.size(); i++) {
+				int32 score = _Score(previous[i].item, folded);
+				if (score == kNoMatch)
+					continue;
+
+				filter_match match = previous[i];
+				match.score = score;
+				level->matches.push_back(match);
+			}
+		}
+		fLevels.push_back(level);
+	}
+
+	// only the best ones are shown, ties in the order of the list
+	std::vector<filter_match>& matches = fLevels.back()->matches;
+	size_t count = std::min(matches.size(), (size_t)maxResults);
+	std::partial_sort(matches.begin(), matches.begin() + count,
+		matches.end(), better_match);
+
+	results.MakeEmpty();
+	for (size_t i = 0; i < count; i++)
+		results.AddItem(matches[i].item);
+}
+
+
+// Returns where the first complete match of the query ends, or NULL.
+static const char*
+match_end(const char* text, const char* textEnd, const char* query,
+	const char* queryEnd)
+{
+	const char* t = text;
+	for (const char* q = query; q < queryEnd;) {
+		int32 length = char_length(q);
+		char needles[2] = { *q, (char)toupper((uint8)*q) };
+		for (;;) {
+			// only the first byte of a character is scanned for
+			t = TextScan::FindAnyByte(t, textEnd - t, needles,
+				needles[0] != needles[1] ? 2 : 1);
+			if (t == NULL)
+				return NULL;
+			if (length == 1 || (textEnd - t >= length
+					&& memcmp(t, q, length) == 0))
+				break;
+			t++;
+		}
+		t += length;
+		q += length;
+	}
+	return t;
+}
+
+
+// Returns kNoMatch if the text doesn't contain the characters of the
+// (lower case) query in order. Otherwise the query is scored where it
+// appears as a whole, or else the shortest stretch of text that ends
+// with the first complete match: every character counts, more so at
+// the start of a word or right after the previous one, while gaps in
+// between and text before the match cost.
+// The text is only scanned for the match, scoring never looks at more
+// than kScoreWindow bytes of it. A match that's spread wider than that
+// still matches, but scores nothing.
+/*static*/ int32
+ClipFilter::Score(const char* text, size_t length, const BString& query)
+{
+	const char* pattern = query.String();
+	if (query.Length() == 0)
+		return 0;
+
+	const char* start = TextScan::FindNoCase(text, length, pattern,
+		query.Length());
+	const char* end;
+	if (start != NULL)
+		end = start + query.Length();
+	else {
+		end = match_end(text, text + length, pattern,
+			pattern + query.Length());
+		if (end == NULL)
+			return kNoMatch;
+
+		// walk back to where the match could start at the latest
+		const char* earliest = text;
+		if ((size_t)(end - text) > kScoreWindow)
+			earliest = end - kScoreWindow;
+		start = end;
+		const char* q = pattern + query.Length();
+		while (q > pattern) {
+			const char* c = previous_char(pattern, q);
+			do {
+				if (start <= earliest)
+					return 0;
+				start = previous_char(text, start);
+			} while (!char_matches(start, c, q - c));
+			q = c;
+		}
+	}
+
+	int32 score = 0;
+	int32 gap = 0;
+	bool consecutive = false;
+	const char* q = pattern;
+	for (const char* t = start; *q != '\0' && t < end;) {
+		int32 length = char_length(q);
+		if (char_matches(t, q, length)) {
+			score += kScoreMatch;
+			if (t == text || is_boundary(t[-1]))
+				score += kBonusBoundary;
+			if (consecutive)
+				score += kBonusConsecutive;
+			else if (gap > 0)
+				score -= kPenaltyGapStart + kPenaltyGapExtension * (gap - 1);
+			consecutive = true;
+			gap = 0;
+			q += length;
+			t += length;
+		} else {
+			consecutive = false;
+			gap++;
+			t = next_char(t);
+		}
+	}
+
+	score -= std::min((int32)(start - text), kMaxLeadingPenalty);
+	return std::max(score, (int32)0);
+}
+
+
+int32
+ClipFilter::_Score(BListItem* item, const BString& query)
+{
+	BString buffer;
+	size_t length;
+	const char* text = fTextOf(item, buffer, length);
+	int32 score = Score(text, length, query);
+	if (fTitleOf != NULL)
+		score = std::max(score, Score(fTitleOf(item), query));
+	return score;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef CLIPFILTER_H
+#define CLIPFILTER_H
+
+#include <List.h>
+#include <ListItem.h>
+#include <String.h>
+
+#include <vector>
+
+#include "ListModel.h"
+
+// the text of an item, the buffer takes it if it has to be unpacked
+typedef const char* (*filter_text_func)(BListItem* item, BString& buffer,
+	size_t& length);
+typedef const BString& (*filter_title_func)(BListItem* item);
+
+struct filter_match {
+	BListItem*			item;
+	int32				score;
+	int32				order;	// index in the unfiltered list
+};
+
+
+// Fuzzy type-to-filter over the texts of a list of items. A text matches
+// if it contains the characters of the query in order, the closer together
+// and the more of them at the start of words, the better it scores. Items
+// with a title of their own match by that as well.
+// The matches of every query are kept until the next one doesn't extend
+// it anymore: another typed character only has to look at what matched
+// before, and deleting one goes right back to the earlier matches.
+class ClipFilter {
+public:
+							ClipFilter(filter_text_func textOf,
+								filter_title_func titleOf = NULL);
+							~ClipFilter();
+
+	// forget all matches, the items may have changed
+	void					Reset();
+	void					Filter(const char* query, const ListModel& items,
+								BList& results, int32 maxResults);
+
+	static int32			Score(const char* text, size_t length,
+								const BString& query);
+	static int32			Score(const BString& title, const BString& query)
+								{ return Score(title.String(), title.Length(),
+									query); };
+
+private:
+	struct filter_level {
+		BString						query;
+		std::vector<filter_match>	matches;
+	};
+
+	int32					_Score(BListItem* item, const BString& query);
+
+	filter_text_func		fTextOf;
+	filter_title_func		fTitleOf;
+	std::vector<filter_level*> fLevels;
+};
+
+#endif // CLIPFILTER_H
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include "ClipHistory.h"
+
+
+ClipHistory::ClipHistory(ClipStore* store, int32 capacity)
+	:
+	fStore(store),
+	fItems(capacity),
+	fBytes(0),
+	fPolicy(EvictionPolicy::Create(kEvictOldest)),
+	fCandidates(EvictionOrder(fPolicy))
+{
+}
+
+
+ClipHistory::~ClipHistory()
+{
+	for (int32 i = 0; i < fItems.CountItems(); i++)
+		delete fItems.ClipAt(i);
+	delete fPolicy;
+}
+
+
+int32
+ClipHistory::IndexOf(ClipData* clip) const
+{
+	ItemMap::const_iterator found = fItemOf.find(clip);
+	if (found == fItemOf.end())
+		return -1;
+
+	return fItems.IndexOf(found->second);
+}
+
+
+bool
+ClipHistory::AddFirst(ClipItem* item)
+{
+	if (!fItems.AddFirst(item))
+		return false;
+
+	_Added(item);
+	return true;
+}
+
+
+bool
+ClipHistory::AddLast(ClipItem* item)
+{
+	if (!fItems.AddLast(item))
+		return false;
+
+	_Added(item);
+	return true;
+}
+
+
+void
+ClipHistory::RemoveItems(int32 index, int32 count)
+{
+	if (index < 0 || count <= 0 || index + count > fItems.CountItems())
+		return;
+
+	for (int32 i = index + count - 1; i >= index; i--) {
+		ClipItem* item = fItems.ClipAt(i);
+		ClipData* clip = item->GetClipData();
+		fItemOf.erase(clip);
+		fBytes -= clip->StoredLength();
+		fCandidates.erase(item);
+
+		// the store only lets go of clips the caller still holds on to
+		clip->AcquireReference();
+		delete item;
+		fStore->Collect(clip);
+		clip->ReleaseReference();
+	}
+	fItems.RemoveItems(index, count);
+}
+
+
+void
+ClipHistory::MoveToFirst(int32 index, int32 time)
+{
+	ClipItem* item = fItems.ClipAt(index);
+	if (item == NULL)
+		return;
+
+	// the policy may see it differently now, it has to be put in again
+	bool candidate = fCandidates.erase(item) > 0;
+	fItems.MoveToFirst(index);
+	item->SetTimeAdded(time);
+	item->SetPasteCount(item->GetPasteCount() + 1);
+	if (candidate)
+		fCandidates.insert(item);
+}
+
+
+void
+ClipHistory::MakeEmpty()
+{
+	for (int32 i = fItems.CountItems() - 1; i >= 0; i--)
+		delete fItems.ClipAt(i);
+	fItems.MakeEmpty();
+	fItemOf.clear();
+	fCandidates.clear();
+	fBytes = 0;
+	fStore->Collect();
+}
+
+
+void
+ClipHistory::SetEvictionPolicy(EvictionPolicy* policy)
+{
+	CandidateSet candidates((EvictionOrder(policy)));
+	CandidateSet::iterator it = fCandidates.begin();
+	for (; it != fCandidates.end(); it++)
+		candidates.insert(*it);
+
+	fCandidates.swap(candidates);
+	delete fPolicy;
+	fPolicy = policy;
+}
+
+
+int32
+ClipHistory::NextEviction() const
+{
+	ClipItem* newest = fItems.ClipAt(0);
+	CandidateSet::const_iterator it = fCandidates.begin();
+	if (it != fCandidates.end() && *it == newest)
+		it++;
+	if (it == fCandidates.end())
+		return -1;
+
+	return fItems.IndexOf(*it);
+}
+
+
+void
+ClipHistory::AddFavorite(ClipData* clip)
+{
+	if (fFavorites[clip]++ > 0)
+		return;
+
+	ItemMap::iterator found = fItemOf.find(clip);
+	if (found != fItemOf.end())
+		fCandidates.erase(found->second);
+}
+
+
+void
+ClipHistory::RemoveFavorite(ClipData* clip)
+{
+	FavoriteMap::iterator favorite = fFavorites.find(clip);
+	if (favorite == fFavorites.end() || --favorite->second > 0)
+		return;
+
+	fFavorites.erase(favorite);
+	ItemMap::iterator found = fItemOf.find(clip);
+	if (found != fItemOf.end())
+		fCandidates.insert(found->second);
+}
+
+
+bool
+ClipHistory::EvictionOrder::operator()(ClipItem* a, ClipItem* b) const
+{
+	if (policy->Prefers(a, b))
+		return true;
+	if (policy->Prefers(b, a))
+		return false;
+	return a < b;
+}
+
+
+void
+ClipHistory::_Added(ClipItem* item)
+{
+	ClipData* clip = item->GetClipData();
+	fItemOf[clip] = item;
+	fBytes += clip->StoredLength();
+	if (!IsFavorite(clip))
+		fCandidates.insert(item);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef CLIPHISTORY_H
+#define CLIPHISTORY_H
+
+#include <map>
+#include <set>
+
+#include "ClipItem.h"
+#include "ClipStore.h"
+#include "EvictionPolicy.h"
+#include "HistoryList.h"
+#include "ListModel.h"
+
+
+// The history clips, newest first, and what's known about them: which
+// item holds which clip, and how many bytes all of them take. It owns the
+// items and gives their clips back to the store once they're removed.
+// The clips that may be evicted are kept in the order of the eviction
+// policy, so finding the next one doesn't look at all the others. Clips
+// that are favorites as well aren't among them.
+// The window journals the changes and tells the views about them, the
+// benchmark drives it directly.
+class ClipHistory : public ListModel {
+public:
+						ClipHistory(ClipStore* store, int32 capacity = 100);
+	virtual				~ClipHistory();
+
+	virtual	int32		CountItems() const { return fItems.CountItems(); };
+	virtual	BListItem*	ItemAt(int32 index) const
+							{ return fItems.ItemAt(index); };
+	ClipItem*			ClipAt(int32 index) const
+							{ return fItems.ClipAt(index); };
+	int32				IndexOf(const ClipItem* item) const
+							{ return fItems.IndexOf(item); };
+	// -1 if the clip isn't in the history
+	int32				IndexOf(ClipData* clip) const;
+	bool				Contains(ClipData* clip) const
+							{ return fItemOf.find(clip) != fItemOf.end(); };
+
+	off_t				Bytes() const { return fBytes; };
+	void				SetCapacity(int32 capacity)
+							{ fItems.SetCapacity(capacity); };
+
+	// the clip of an item mustn't be in the history already
+	bool				AddFirst(ClipItem* item);
+	bool				AddLast(ClipItem* item);
+	// deletes the items
+	void				RemoveItems(int32 index, int32 count);
+	// a clip that's pasted again comes back to the front
+	void				MoveToFirst(int32 index, int32 time);
+	void				MakeEmpty();
+
+	// takes over the policy
+	void				SetEvictionPolicy(EvictionPolicy* policy);
+	// the index of the clip to evict next, -1 if there's none, the newest
+	// clip is what's in the clipboard and always stays
+	int32				NextEviction() const;
+
+	// a clip can be a favorite more than once
+	void				AddFavorite(ClipData* clip);
+	void				RemoveFavorite(ClipData* clip);
+	bool				IsFavorite(ClipData* clip) const
+							{ return fFavorites.count(clip) > 0; };
+
+private:
+	typedef std::map<ClipData*, ClipItem*> ItemMap;
+	typedef std::map<ClipData*, int32> FavoriteMap;
+
+	// the clip the policy evicts first comes first, the order of the
+	// pointers decides between clips the policy has no preference for
+	struct EvictionOrder {
+							EvictionOrder(const EvictionPolicy* policy)
+								: policy(policy) {};
+
+		bool				operator()(ClipItem* a, ClipItem* b) const;
+
+		const EvictionPolicy* policy;
+	};
+	typedef std::set<ClipItem*, EvictionOrder> CandidateSet;
+
+	void				_Added(ClipItem* item);
+
+	ClipStore*			fStore;
+	HistoryList			fItems;
+	ItemMap				fItemOf;
+	off_t				fBytes;
+	EvictionPolicy*		fPolicy;
+	CandidateSet		fCandidates;
+	FavoriteMap			fFavorites;
+};
+
+#endif // CLIPHISTORY_H
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <Clipboard.h>
+#include <Entry.h>
+#include <OS.h>
+#include <Path.h>
+#include <Roster.h>
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "ClipIngest.h"
+#include "ClipItem.h"
+#include "ClipStore.h"
+#include "Constants.h"
+
+
+ClipIngest::ClipIngest(ClipStore* store, BMessenger target)
+	:
+	BLooper("clip ingest", B_NORMAL_PRIORITY),
+	fStore(store),
+	fTarget(target),
+	fQuietTime(0),
+	fMaxLatency(0),
+	fPending(false),
+	fFirstChange(0),
+	fLastChange(0),
+	fCheckRunner(NULL),
+	fChanges(0),
+	fCoalesced(0)
+{
+}
+
+
+ClipIngest::~ClipIngest()
+{
+	delete fCheckRunner;
+}
+
+
+void
+ClipIngest::SetCoalescing(bigtime_t quiet, bigtime_t maxLatency)
+{
+	fQuietTime = quiet;
+	fMaxLatency = maxLatency;
+}
+
+
+void
+ClipIngest::MessageReceived(BMessage* message)
+{
+	switch (message->what) {
+		case B_CLIPBOARD_CHANGED:
+		{
+			_ClipboardChanged();
+			break;
+		}
+		case INGEST_CHECK:
+		{
+			_CheckPending();
+			break;
+		}
+		default:
+		{
+			BLooper::MessageReceived(message);
+			break;
+		}
+	}
+}
+
+
+void
+ClipIngest::_ClipboardChanged()
+{
+	atomic_add(&fChanges, 1);
+	if (fQuietTime <= 0) {
+		fOrigin = _ActiveAppPath();
+		_Ingest();
+		return;
+	}
+
+	bigtime_t now = system_time();
+	if (fPending)
+		atomic_add(&fCoalesced, 1);
+	else {
+		fPending = true;
+		fFirstChange = now;
+		fOrigin = _ActiveAppPath();
+	}
+	fLastChange = now;
+
+	if (now - fFirstChange >= fMaxLatency)
+		_Ingest();
+	else if (fCheckRunner == NULL)
+		_ScheduleCheck(fQuietTime);
+}
+
+
+void
+ClipIngest::_CheckPending()
+{
+	delete fCheckRunner;
+	fCheckRunner = NULL;
+	if (!fPending)
+		return;
+
+	// changes that came in meanwhile pushed the deadline back
+	bigtime_t due = std::min(fLastChange + fQuietTime,
+		fFirstChange + fMaxLatency);
+	bigtime_t now = system_time();
+	if (now >= due)
+		_Ingest();
+	else
+		_ScheduleCheck(due - now);
+}
+
+
+void
+ClipIngest::_ScheduleCheck(bigtime_t delay)
+{
+	BMessage check(INGEST_CHECK);
+	fCheckRunner = new BMessageRunner(BMessenger(this), &check, delay, 1);
+}
+
+
+void
+ClipIngest::_Ingest()
+{
+	fPending = false;
+	delete fCheckRunner;
+	fCheckRunner = NULL;
+	bigtime_t start = system_time();
+
+	// identical texts are interned to the same clip, which
+	// makes finding an older copy a simple lookup for the window
+	ClipData* clip = _InternClipboard();
+	if (clip == NULL)
+		return;
+
+	BString title;
+	clip->GetTitle(title);
+	ClipItem* item = new ClipItem(clip, title, fOrigin, real_time_clock());
+	clip->ReleaseReference();
+
+	BMessage ingested(CLIP_INGESTED);
+	ingested.AddPointer("item", item);
+	ingested.AddInt64("start", start);
+	if (fTarget.SendMessage(&ingested) != B_OK)
+		delete item;
+}
+
+
+ClipData*
+ClipIngest::_InternClipboard()
+{
+	// The text goes right from the clipboard into the store, without
+	// an extra copy, huge ones are spilled to disk from there.
+	ClipData* clip = NULL;
+	if (be_clipboard->Lock()) {
+		BMessage* clipboard = be_clipboard->Data();
+		const char* text;
+		ssize_t textLen;
+		if (clipboard != NULL && clipboard->FindData("text/plain",
+				B_MIME_TYPE, (const void **)&text, &textLen) == B_OK) {
+			textLen = strnlen(text, textLen);
+			if (textLen > 0)
+				clip = fStore->Intern(text, textLen);
+		}
+		be_clipboard->Unlock();
+	}
+	return clip;
+}
+
+
+/*static*/ BString
+ClipIngest::_ActiveAppPath()
+{
+	app_info info;
+	BPath path;
+	if (be_roster->GetActiveAppInfo(&info) == B_OK) {
+		BEntry entry(&info.ref);
+		entry.GetPath(&path);
+	}
+	return path.Path();
+}
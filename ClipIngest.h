@@ -0,0 +1,66 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef CLIPINGEST_H
+#define CLIPINGEST_H
+
+#include <Looper.h>
+#include <MessageRunner.h>
+#include <Messenger.h>
+#include <String.h>
+
+class ClipData;
+class ClipStore;
+
+
+// Takes in what's copied to the clipboard in a looper of its own. The
+// text is hashed, interned and maybe spilled to disk there, the app it
+// came from and its icon are looked up, and the finished ClipItem is sent
+// to the window in a CLIP_INGESTED message, which only has to insert it.
+// Bursts of changes, like while a selection is dragged, are coalesced:
+// the clipboard is only taken in once it stayed the same for the quiet
+// time, or the burst went on for the maximum latency. The clip's origin
+// is the app that was active when the burst started, the user may have
+// switched to another one by the time it's taken in.
+class ClipIngest : public BLooper {
+public:
+						ClipIngest(ClipStore* store, BMessenger target);
+	virtual				~ClipIngest();
+
+	virtual	void		MessageReceived(BMessage* message);
+
+	// in microseconds, a quiet time of 0 takes in every change
+	void				SetCoalescing(bigtime_t quiet, bigtime_t maxLatency);
+
+	int32				CountChanges() { return atomic_get(&fChanges); };
+	int32				CountCoalesced() { return atomic_get(&fCoalesced); };
+
+private:
+	void				_ClipboardChanged();
+	void				_CheckPending();
+	void				_ScheduleCheck(bigtime_t delay);
+	void				_Ingest();
+	ClipData*			_InternClipboard();
+	static BString		_ActiveAppPath();
+
+	ClipStore*			fStore;
+	BMessenger			fTarget;
+
+	bigtime_t			fQuietTime;
+	bigtime_t			fMaxLatency;
+	bool				fPending;
+	bigtime_t			fFirstChange;
+	bigtime_t			fLastChange;
+	BMessageRunner*		fCheckRunner;
+	BString				fOrigin;
+
+	int32				fChanges;
+	int32				fCoalesced;
+};
+
+#endif // CLIPINGEST_H
@@ -7,8 +7,6 @@
  */
 
 #include <ControlLook.h>
-#include <Node.h>
-#include <NodeInfo.h>
 
 #include <stdio.h>
 
@@ -17,33 +15,41 @@
 #include "Constants.h"
 
 
-ClipItem::ClipItem(BString clip, BString path, int32 time)
+ClipItem::ClipItem(ClipData* clip, const BString& title, const BString& path,
+	int32 time)
 	:
 	BListItem()
 {
 	fClip = clip;
+	fClip->AcquireReference();
+	// titles of older history files may still be long or span lines
+	ClipData::MakeTitle(title.String(), title.Length(), fClipTitle);
 	fOrigin = path;
 	fTimeAdded = time;
+	fPasteCount = 0;
 	fColor = ui_color(B_LIST_BACKGROUND_COLOR);
+	fFadeDeadline = 0;
 
-	BNode node;
-	BNodeInfo node_info;
-
-	if ((node.SetTo(path.String()) == B_NO_ERROR) &&
-			(node_info.SetTo(&node) == B_NO_ERROR)) {
-		fOriginIcon = new BBitmap(BRect(0, 0, kIconSize - 1, kIconSize - 1),
-			0, B_RGBA32);
-		status_t status = node_info.GetTrackerIcon(fOriginIcon, B_MINI_ICON);
-		if (status != B_OK)
-			fOriginIcon = NULL;
-	} else
-		fOriginIcon = NULL;
+	// shared with all other clips from the same app
+	fOriginIcon = my_app->Icons()->GetIcon(path.String());
 }
 
 
 ClipItem::~ClipItem()
 {
-	delete fOriginIcon;
+	fClip->ReleaseReference();
+}
+
+
+bool
+ClipItem::SetColor(rgb_color color)
+{
+	// tells if the row needs to be drawn again
+	if (color == fColor)
+		return false;
+
+	fColor = color;
+	return true;
 }
 
 
@@ -72,8 +78,7 @@ ClipItem::DrawItem(BView *view, BRect rect, bool complete)
         view->DrawBitmap(fOriginIcon, BPoint(rect.left + spacing,
 			rect.top + (rect.Height() - kIconSize) / 2));
         view->SetDrawingMode(B_OP_COPY);
-	} else
-		printf("Found no icon\n");
+	}
 
 	// text
 	if (IsSelected())
@@ -86,7 +91,8 @@ ClipItem::DrawItem(BView *view, BRect rect, bool complete)
 	font_height	fheight;
 	font.GetHeight(&fheight);
 
-    view->DrawString(fTitle.String(),
+	float width = rect.Width() - kIconSize - spacing * 4;
+    view->DrawString(fTitle.Get(fClipTitle, font, width).String(),
 		BPoint(kIconSize - 1 + spacing * 3,
 		rect.top + fheight.ascent + fheight.descent + fheight.leading));
 
@@ -98,23 +104,3 @@ ClipItem::DrawItem(BView *view, BRect rect, bool complete)
 		BPoint(kIconSize - 1 + spacing * 2, rect.bottom));
 }
 
-
-void
-ClipItem::Update(BView* view, const BFont* finfo)
-{
-	// we need to DefaultLabelSpacing the update method so we can make sure the
-	// list item size doesn't change
-	BListItem::Update(view, finfo);
-
-	static const float spacing = be_control_look->DefaultLabelSpacing();
-	BString string(GetClip());
-	view->TruncateString(&string, B_TRUNCATE_END, Width() - kIconSize
-			- spacing * 4);
-	SetTitle(string);
-
-	font_height	fheight;
-	finfo->GetHeight(&fheight);
-
-	SetHeight(ceilf(fheight.ascent + 2 + fheight.leading / 2
-		+ fheight.descent) + 5);
-}
@@ -15,31 +15,40 @@
 #include <ListItem.h>
 #include <String.h>
 
+#include "ClipData.h"
+#include "TruncatedTitle.h"
+
 
 class ClipItem : public BListItem {
 public:
-					ClipItem(BString clip, BString path, int32 time);
+					ClipItem(ClipData* clip, const BString& title,
+						const BString& path, int32 time);
 					~ClipItem();
 
-	BString			GetClip() { return fClip; };
+	ClipData*		GetClipData() { return fClip; };
+	const BString&	GetClipTitle() { return fClipTitle; };
 	BString			GetOrigin() { return fOrigin; };
 	bigtime_t		GetTimeAdded() { return fTimeAdded; };
 	void			SetTimeAdded(int32 time) { fTimeAdded = time; };
-	rgb_color		SetColor(rgb_color color) { fColor = color; };
-	BString			GetTitle() { return fTitle; };
-	void			SetTitle(BString title) { fTitle = title; };
+	int32			GetPasteCount() { return fPasteCount; };
+	void			SetPasteCount(int32 count) { fPasteCount = count; };
+	bool			SetColor(rgb_color color);
+	int32			GetFadeDeadline() { return fFadeDeadline; };
+	void			SetFadeDeadline(int32 time) { fFadeDeadline = time; };
 
 	virtual void	DrawItem(BView* view, BRect rect, bool complete);
-	virtual	void	Update(BView* view, const BFont* finfo);
 
 private:
-	BString			fClip;
-	BString			fTitle;
+	ClipData*		fClip;
+	BString			fClipTitle;
+	TruncatedTitle	fTitle;
 	BString			fOrigin;
 	int32			fTimeAdded;
+	int32			fPasteCount;
 	rgb_color		fColor;
+	int32			fFadeDeadline;	// belongs to the FadeSchedule
 
-	BBitmap*		fOriginIcon;
+	BBitmap*		fOriginIcon;	// belongs to the IconCache
 };
 
 #endif // CLIPITEM_H
@@ -0,0 +1,287 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <Autolock.h>
+#include <Directory.h>
+#include <Entry.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ClipStore.h"
+
+
+ClipStore::ClipStore()
+	:
+	fLock("clip store"),
+	fSpillThreshold(0),
+	fDedupHits(0)
+{
+}
+
+
+ClipStore::~ClipStore()
+{
+	for (ClipMap::iterator it = fClips.begin(); it != fClips.end(); it++)
+		it->second->ReleaseReference();
+}
+
+
+// Returns a reference to the clip with the given text, which is only
+// copied if the store doesn't know it yet.
+ClipData*
+ClipStore::Intern(const char* data, size_t length)
+{
+	clip_digest digest;
+	ClipData::MakeDigest(data, length, digest);
+
+	bool spill = false;
+	BPath path;
+	{
+		BAutolock _(fLock);
+
+		ClipMap::iterator found = fClips.find(digest);
+		if (found != fClips.end()) {
+			fDedupHits++;
+			found->second->AcquireReference();
+			return found->second;
+		}
+
+		// only one spill file is written for the same text at a time
+		if (fSpillThreshold > 0 && length >= fSpillThreshold
+			&& fSpillDirectory.InitCheck() == B_OK)
+			spill = fSpilling.insert(digest).second;
+		if (spill)
+			path = _SpillPath(digest);
+	}
+
+	// copying, packing or writing a large text doesn't keep the others
+	// from the store
+	ClipData* clip = NULL;
+	if (spill && ClipData::WriteSpillFile(path, data, length) == B_OK)
+		clip = new ClipData(path, length, digest);
+	if (clip == NULL)
+		clip = new ClipData(data, length, digest);
+	if (clip->InitCheck() != B_OK) {
+		clip->ReleaseReference();
+		clip = NULL;
+	}
+
+	BAutolock _(fLock);
+	if (spill)
+		fSpilling.erase(digest);
+	if (clip == NULL)
+		return NULL;
+	return _Add(clip);
+}
+
+
+// Takes over the caller's reference to the clip and returns a reference
+// to the stored clip with the same contents, which may be another one.
+ClipData*
+ClipStore::Intern(ClipData* clip)
+{
+	BAutolock _(fLock);
+	return _Add(clip);
+}
+
+
+// Returns a reference to a clip whose text was spilled before.
+ClipData*
+ClipStore::InternSpilled(size_t length, const clip_digest& digest)
+{
+	if (fSpillDirectory.InitCheck() != B_OK)
+		return NULL;
+
+	return Intern(new ClipData(_SpillPath(digest), length, digest));
+}
+
+
+void
+ClipStore::Collect(ClipData* clip)
+{
+	BAutolock _(fLock);
+
+	// only our own reference left, besides the one of the caller
+	ClipMap::iterator found = fClips.find(clip->Digest());
+	if (found == fClips.end() || found->second != clip
+		|| clip->CountReferences() > 2)
+		return;
+
+	_Remove(found);
+}
+
+
+void
+ClipStore::Collect()
+{
+	BAutolock _(fLock);
+
+	ClipMap::iterator it = fClips.begin();
+	while (it != fClips.end()) {
+		if (it->second->CountReferences() > 1) {
+			it++;
+			continue;
+		}
+		_Remove(it++);
+	}
+}
+
+
+int32
+ClipStore::CountClips()
+{
+	BAutolock _(fLock);
+	return fClips.size();
+}
+
+
+int64
+ClipStore::CountDedupHits()
+{
+	BAutolock _(fLock);
+	return fDedupHits;
+}
+
+
+status_t
+ClipStore::SetSpillDirectory(const char* path)
+{
+	BAutolock _(fLock);
+
+	status_t status = create_directory(path, 0777);
+	if (status == B_OK)
+		status = fSpillDirectory.SetTo(path);
+	return status;
+}
+
+
+void
+ClipStore::SetSpillThreshold(size_t threshold)
+{
+	BAutolock _(fLock);
+	fSpillThreshold = threshold;
+}
+
+
+// Removes spill files no clip refers to, like those of clips that were
+// added right before a crash, and never made it into the journal.
+void
+ClipStore::PurgeSpillDirectory()
+{
+	BAutolock _(fLock);
+
+	BDirectory directory(fSpillDirectory.Path());
+	BEntry entry;
+	while (directory.GetNextEntry(&entry) == B_OK) {
+		char name[B_FILE_NAME_LENGTH];
+		entry.GetName(name);
+
+		clip_digest digest;
+		bool valid = strlen(name) == sizeof(digest.bytes) * 2;
+		for (size_t i = 0; valid && i < sizeof(digest.bytes); i++) {
+			unsigned int byte;
+			valid = sscanf(name + i * 2, "%2x", &byte) == 1;
+			digest.bytes[i] = byte;
+		}
+
+		ClipMap::iterator found = fClips.find(digest);
+		if (!valid || found == fClips.end() || !found->second->IsSpilled())
+			entry.Remove();
+	}
+}
+
+
+void
+ClipStore::RetireSpillFiles(int32 generation)
+{
+	BAutolock _(fLock);
+
+	RetiredMap::iterator it = fRetired.begin();
+	for (; it != fRetired.end(); it++) {
+		if (it->second < 0)
+			it->second = generation;
+	}
+}
+
+
+void
+ClipStore::DeleteSpillFiles(int32 savedGeneration)
+{
+	BAutolock _(fLock);
+
+	RetiredMap::iterator it = fRetired.begin();
+	while (it != fRetired.end()) {
+		// a file that's just written again stays retired until its clip
+		// is added
+		if (it->second < 0 || it->second > savedGeneration
+			|| fSpilling.count(it->first) > 0) {
+			it++;
+			continue;
+		}
+
+		BEntry entry(_SpillPath(it->first).Path());
+		entry.Remove();
+		fRetired.erase(it++);
+	}
+}
+
+
+BPath
+ClipStore::_SpillPath(const clip_digest& digest)
+{
+	char name[sizeof(digest.bytes) * 2 + 1];
+	for (size_t i = 0; i < sizeof(digest.bytes); i++)
+		sprintf(name + i * 2, "%02x", digest.bytes[i]);
+
+	BPath path(fSpillDirectory);
+	path.Append(name);
+	return path;
+}
+
+
+ClipData*
+ClipStore::_Add(ClipData* clip)
+{
+	ClipMap::iterator found = fClips.find(clip->Digest());
+	if (found != fClips.end()) {
+		if (found->second != clip) {
+			// the same text was interned in the meantime, a spill file
+			// of our own is only left if that one wasn't spilled
+			if (clip->IsSpilled() && !found->second->IsSpilled()) {
+				BEntry entry(clip->SpillPath());
+				entry.Remove();
+			}
+			found->second->AcquireReference();
+			clip->ReleaseReference();
+		}
+		return found->second;
+	}
+
+	// the same text may come back before its spill file was deleted
+	if (clip->IsSpilled())
+		fRetired.erase(clip->Digest());
+
+	clip->AcquireReference();
+	fClips[clip->Digest()] = clip;
+	return clip;
+}
+
+
+void
+ClipStore::_Remove(ClipMap::iterator it)
+{
+	ClipData* clip = it->second;
+	fClips.erase(it);
+
+	// nobody can get to the text anymore, but the last snapshot may
+	// still refer to it
+	if (clip->IsSpilled())
+		fRetired[clip->Digest()] = -1;
+	clip->ReleaseReference();
+}
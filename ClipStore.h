@@ -0,0 +1,76 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef CLIPSTORE_H
+#define CLIPSTORE_H
+
+#include <Locker.h>
+#include <Path.h>
+
+#include <map>
+#include <set>
+
+#include "ClipData.h"
+
+
+// Content addressed store of all clip texts, shared by history and
+// favorites. Every text is held exactly once, keyed by its digest.
+// The store keeps one reference to each clip and lets go of it in
+// Collect(), once nobody else uses the clip anymore. Collect(clip) expects
+// the caller to still hold a reference to the clip.
+// Texts of the spill threshold and larger go to a file named after their
+// digest in the spill directory. The history snapshot and its journal may
+// still refer to the file of a collected clip, it's retired along with
+// the next snapshot and only deleted once that one is written.
+class ClipStore {
+public:
+						ClipStore();
+						~ClipStore();
+
+	ClipData*			Intern(const char* data, size_t length);
+	ClipData*			Intern(ClipData* clip);
+	ClipData*			InternSpilled(size_t length,
+							const clip_digest& digest);
+
+	void				Collect(ClipData* clip);
+	void				Collect();
+
+	int32				CountClips();
+	// how many texts were already stored when they were interned
+	int64				CountDedupHits();
+
+	status_t			SetSpillDirectory(const char* path);
+	void				SetSpillThreshold(size_t threshold);
+	void				PurgeSpillDirectory();
+	// the files of the clips collected until now, for the snapshot of the
+	// given generation
+	void				RetireSpillFiles(int32 generation);
+	// those retired up to the snapshot of the given generation
+	void				DeleteSpillFiles(int32 savedGeneration);
+
+private:
+	typedef std::map<clip_digest, ClipData*> ClipMap;
+	// the generation of the snapshot a spill file was retired for, -1
+	// until there's one
+	typedef std::map<clip_digest, int32> RetiredMap;
+
+	BPath				_SpillPath(const clip_digest& digest);
+	ClipData*			_Add(ClipData* clip);
+	void				_Remove(ClipMap::iterator it);
+
+	BLocker				fLock;
+	ClipMap				fClips;
+	// texts whose spill file is being written, outside of the lock
+	std::set<clip_digest> fSpilling;
+	RetiredMap			fRetired;
+	BPath				fSpillDirectory;
+	size_t				fSpillThreshold;
+	int64				fDedupHits;
+};
+
+#endif // CLIPSTORE_H
@@ -22,7 +22,7 @@
 
 ClipView::ClipView(const char* name)
 	:
-	BListView(name)
+	VirtualListView(name)
 {
 }
 
@@ -32,48 +32,6 @@ ClipView::~ClipView()
 }
 
 
-void
-ClipView::AttachedToWindow()
-{
-	SetFlags(Flags() | B_FULL_UPDATE_ON_RESIZE | B_NAVIGABLE);
-
-	BMessage message(ADJUSTCOLORS);
-	fRunner	= new BMessageRunner(this, &message, kMinuteUnits * 60000000);
-
-	BListView::AttachedToWindow();
-}
-
-
-void
-ClipView::FrameResized(float width, float height)
-{
-	BListView::FrameResized(width, height);
-
-	static const float spacing = be_control_look->DefaultLabelSpacing();
-
-	for (int32 i = 0; i < CountItems(); i++) {
-		ClipItem *sItem = dynamic_cast<ClipItem *> (ItemAt(i));
-		BString string(sItem->GetClip());
-		TruncateString(&string, B_TRUNCATE_END, width - kIconSize
-			- spacing * 4);
-		sItem->SetTitle(string);
-	}
-}
-
-void
-ClipView::Draw(BRect rect)
-{
-	SetHighColor(ui_color(B_CONTROL_BACKGROUND_COLOR));
-
-	BRect bounds(Bounds());
-	BRect itemFrame = ItemFrame(CountItems() - 1);
-	bounds.top = itemFrame.bottom;
-	FillRect(bounds);
-
-	BListView::Draw(rect);
-}
-
-
 void
 ClipView::MessageReceived(BMessage* message)
 {
@@ -83,15 +41,9 @@ ClipView::MessageReceived(BMessage* message)
 			fShowingPopUpMenu = false;
 			break;
 		}
-		case ADJUSTCOLORS:
-		{
-			AdjustColors();
-			Invalidate();
-			break;
-		}
 		default:
 		{
-			BListView::MessageReceived(message);
+			VirtualListView::MessageReceived(message);
 			break;
 		}
 	}
@@ -115,50 +67,30 @@ ClipView::KeyDown(const char* bytes, int32 numBytes)
 			Looper()->PostMessage(&message);
 			break;
 		}
+		case B_BACKSPACE:
+		{
+			BMessage message(FILTER_TYPED);
+			message.AddString("bytes", bytes);
+			Looper()->PostMessage(&message);
+			break;
+		}
 		default:
 		{
-			BListView::KeyDown(bytes, numBytes);
+			// typing filters the lists, a space as well
+			if ((uint8)bytes[0] >= B_SPACE
+				&& (modifiers() & B_COMMAND_KEY) == 0) {
+				BMessage message(FILTER_TYPED);
+				message.AddString("bytes", bytes);
+				Looper()->PostMessage(&message);
+				break;
+			}
+			VirtualListView::KeyDown(bytes, numBytes);
 			break;
 		}
 	}
 }
 
 
-void
-ClipView::AdjustColors()
-{
-	bool fade;
-	int32 delay;
-	int32 step;
-	float maxlevel;
-	bool pause;
-	ClipdingerSettings* settings = my_app->Settings();
-	if (settings->Lock()) {
-		fade = settings->GetFade();
-		step = settings->GetFadeStep();
-		delay = settings->GetFadeDelay() * kMinuteUnits;
-		maxlevel = 1.0 + 0.025 * settings->GetFadeMaxLevel();
-		pause = settings->GetFadePause();
-		settings->Unlock();
-	}
-
-	if (pause)
-		return;
-
-	int32 now(real_time_clock());
-	for (int32 i = 0; i < CountItems(); i++) {
-		ClipItem *sItem = dynamic_cast<ClipItem *> (ItemAt(i));
-		if (fade) {
-			int32 minutes = (now - sItem->GetTimeAdded()) / 60;
-			float level = B_NO_TINT + (maxlevel/ step * ((float)minutes / delay));
-			sItem->SetColor(tint_color(ui_color(B_LIST_BACKGROUND_COLOR),
-			(level < maxlevel) ? level : maxlevel));  // limit to maxlevel
-		} else
-			sItem->SetColor(ui_color(B_LIST_BACKGROUND_COLOR));
-	}
-}
-
-
 void
 ClipView::MouseDown(BPoint position)
 {
@@ -166,18 +98,24 @@ ClipView::MouseDown(BPoint position)
 	message.AddInt32("listview", (int32)1);
 	Looper()->PostMessage(&message);
 
-	BRect bounds(Bounds());
-	BRect itemFrame = ItemFrame(CountItems() - 1);
-	bounds.top = itemFrame.bottom;
-	if (bounds.Contains(position) == false) {
-		uint32 buttons = 0;
-		if (Window() != NULL && Window()->CurrentMessage() != NULL)
-			buttons = Window()->CurrentMessage()->FindInt32("buttons");
+	uint32 buttons = 0;
+	if (Window() != NULL && Window()->CurrentMessage() != NULL)
+		buttons = Window()->CurrentMessage()->FindInt32("buttons");
 
-		if (buttons == B_SECONDARY_MOUSE_BUTTON)
-			ShowPopUpMenu(ConvertToScreen(position));
+	int32 index = IndexOf(position);
+	if (buttons != B_SECONDARY_MOUSE_BUTTON || index < 0) {
+		VirtualListView::MouseDown(position);
+		return;
 	}
-	BListView::MouseDown(position);
+
+	// a right-click into the selection keeps it, so the menu can paste all
+	// the selected clips, anywhere else it selects the clicked clip first
+	if (IsItemSelected(index))
+		MakeFocus(true);
+	else
+		VirtualListView::MouseDown(position);
+
+	ShowPopUpMenu(ConvertToScreen(position));
 }
 
 
@@ -201,6 +139,26 @@ ClipView::ShowPopUpMenu(BPoint screen)
 		new BMessage(PASTE_SPRUNGE));
 	menu->AddItem(item);
 
+	if (CountSelected() > 1) {
+		menu->AddSeparatorItem();
+
+		item = new BMenuItem(B_TRANSLATE("Paste selected clips"),
+			new BMessage(PASTE_SEQUENCE));
+		menu->AddItem(item);
+
+		BMessage* message = new BMessage(PASTE_SEQUENCE);
+		message->AddInt32("separator", B_TAB);
+		item = new BMenuItem(B_TRANSLATE("Paste selected clips, "
+			"separated by Tab"), message);
+		menu->AddItem(item);
+
+		message = new BMessage(PASTE_SEQUENCE);
+		message->AddInt32("separator", B_RETURN);
+		item = new BMenuItem(B_TRANSLATE("Paste selected clips, "
+			"separated by Return"), message);
+		menu->AddItem(item);
+	}
+
 	menu->SetTargetForItems(Looper());
 	menu->Go(screen, true, true, true);
 	fShowingPopUpMenu = true;
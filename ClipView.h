@@ -9,29 +9,24 @@
 #ifndef CLIPVIEW_H
 #define CLIPVIEW_H
 
-#include <ListView.h>
 #include <MenuItem.h>
-#include <MessageRunner.h>
 
+#include "VirtualListView.h"
 
-class ClipView : public BListView {
+
+class ClipView : public VirtualListView {
 public:
 					ClipView(const char* name);
 					~ClipView();
 
-	virtual void	AttachedToWindow();
-	virtual void	Draw(BRect rect);
-	virtual	void	FrameResized(float width, float height);
 	virtual	void	MessageReceived(BMessage* message);
 	virtual	void	KeyDown(const char* bytes, int32 numBytes);
 	void			MouseDown(BPoint position);
 
-	void			AdjustColors();
 	void			ShowPopUpMenu(BPoint screen);
 
 private:
 	bool			fShowingPopUpMenu;
-	BMessageRunner*	fRunner;
 };
 
 #endif // CLIPVIEW_H
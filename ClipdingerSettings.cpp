@@ -8,11 +8,13 @@
 
 #include <Application.h>
 #include <Directory.h>
+#include <Entry.h>
 #include <File.h>
 #include <FindDirectory.h>
 #include <Font.h>
 #include <Path.h>
 #include <Message.h>
+#include <String.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,17 +22,40 @@
 #include "Constants.h"
 #include "ClipdingerSettings.h"
 
+struct settings_job {
+	BMessage		settings;
+	BPath			path;
+	int32			changes;
+	int32*			savedChanges;
+	int32*			saving;
+	ClipdingerSettings* owner;
+};
+
 
 ClipdingerSettings::ClipdingerSettings()
 	:
 	fLimit(kDefaultLimit),
+	fMemoryLimit(kDefaultMemoryLimit),
+	fEviction(kDefaultEviction),
+	fSpillThreshold(kDefaultSpillThreshold),
 	fAutoPaste(kDefaultAutoPaste),
+	fPasteDelay(kDefaultPasteDelay),
 	fFade(kDefaultFade),
 	fFadeDelay(kDefaultFadeDelay),
 	fFadeStep(kDefaultFadeStep),
 	fFadeMaxLevel(kDefaultFadeMaxLevel),
 	fFadePause(0),
-	dirtySettings(false)
+	fCoalesceQuiet(kDefaultCoalesceQuiet),
+	fCoalesceLatency(kDefaultCoalesceLatency),
+	fChanges(0),
+	fSavedChanges(0),
+	fSaveThread(-1),
+	fSaving(0),
+	fSaves(0),
+	fSaveFailures(0),
+	fLastSaveLatency(0),
+	fMaxSaveLatency(0),
+	fLastSaveBytes(0)
 {
 	fPosition.Set(-1, -1, -1, -1);
 	BPath path;
@@ -46,9 +71,21 @@ ClipdingerSettings::ClipdingerSettings()
 				if (msg.FindInt32("limit", &fLimit) != B_OK)
 					fLimit = kDefaultLimit;
 
+				if (msg.FindInt32("memorylimit", &fMemoryLimit) != B_OK)
+					fMemoryLimit = kDefaultMemoryLimit;
+
+				if (msg.FindInt32("eviction", &fEviction) != B_OK)
+					fEviction = kDefaultEviction;
+
+				if (msg.FindInt32("spillthreshold", &fSpillThreshold) != B_OK)
+					fSpillThreshold = kDefaultSpillThreshold;
+
 				if (msg.FindInt32("autopaste", &fAutoPaste) != B_OK)
 					fAutoPaste = kDefaultAutoPaste;
 
+				if (msg.FindInt32("pastedelay", &fPasteDelay) != B_OK)
+					fPasteDelay = kDefaultPasteDelay;
+
 				if (msg.FindInt32("fade", &fFade) != B_OK)
 					fFade = kDefaultFade;
 
@@ -61,6 +98,13 @@ ClipdingerSettings::ClipdingerSettings()
 				if (msg.FindInt32("fademax", &fFadeMaxLevel) != B_OK)
 					fFadeStep = kDefaultFadeMaxLevel;
 
+				if (msg.FindInt32("coalescequiet", &fCoalesceQuiet) != B_OK)
+					fCoalesceQuiet = kDefaultCoalesceQuiet;
+
+				if (msg.FindInt32("coalescelatency", &fCoalesceLatency)
+						!= B_OK)
+					fCoalesceLatency = kDefaultCoalesceLatency;
+
 				if (msg.FindRect("windowlocation", &fPosition) != B_OK)
 					fPosition.Set(-1, -1, -1, -1);
 
@@ -83,55 +127,140 @@ ClipdingerSettings::ClipdingerSettings()
 
 ClipdingerSettings::~ClipdingerSettings()
 {
-	if (!dirtySettings)
-		return;
+	Save(true);
+}
 
-	BPath path;
-	BMessage msg;
 
-	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) < B_OK)
-		return;
-	status_t ret = path.Append(kSettingsFolder);
+bool
+ClipdingerSettings::Lock()
+{
+	return fLock.Lock();
+}
 
-	if (ret == B_OK)
-		ret = create_directory(path.Path(), 0777);
 
-	if (ret == B_OK)
-		path.Append(kSettingsFile);
+void
+ClipdingerSettings::Unlock()
+{
+	fLock.Unlock();
+}
 
-	if (ret == B_OK) {
-		BFile file(path.Path(), B_WRITE_ONLY | B_CREATE_FILE);
-		ret = file.InitCheck();
 
-		if (ret == B_OK) {
-			msg.AddInt32("limit", fLimit);
-			msg.AddInt32("autopaste", fAutoPaste);
-			msg.AddInt32("fade", fFade);
-			msg.AddInt32("fadedelay", fFadeDelay);
-			msg.AddInt32("fadestep", fFadeStep);
-			msg.AddInt32("fademax", fFadeMaxLevel);
-			msg.AddRect("windowlocation", fPosition);
-			msg.AddFloat("split_weight_left", fLeftWeight);
-			msg.AddFloat("split_weight_right", fRightWeight);
-			msg.AddBool("split_collapse_left", fLeftCollapse);
-			msg.AddBool("split_collapse_right", fRightCollapse);
-			msg.Flatten(&file);
-		}
+// Writes the settings from a thread of its own, unless asked to wait.
+// Callers other than the destructor need to hold the lock.
+status_t
+ClipdingerSettings::Save(bool wait)
+{
+	if (fSaveThread >= 0) {
+		if (!wait && atomic_get(&fSaving) != 0)
+			return B_BUSY;
+		status_t result;
+		wait_for_thread(fSaveThread, &result);
+		fSaveThread = -1;
+	}
+
+	// a failed write leaves the changes unsaved, the next save retries
+	if (fChanges == atomic_get(&fSavedChanges))
+		return B_OK;
+
+	BPath path;
+	status_t ret = find_directory(B_USER_SETTINGS_DIRECTORY, &path);
+	if (ret == B_OK)
+		ret = path.Append(kSettingsFolder);
+	if (ret == B_OK)
+		ret = create_directory(path.Path(), 0777);
+	if (ret == B_OK)
+		ret = path.Append(kSettingsFile);
+	if (ret != B_OK)
+		return ret;
+
+	settings_job* job = new settings_job;
+	job->path = path;
+	job->changes = fChanges;
+	job->savedChanges = &fSavedChanges;
+	job->saving = &fSaving;
+	job->owner = this;
+
+	BMessage& msg = job->settings;
+	msg.AddInt32("limit", fLimit);
+	msg.AddInt32("memorylimit", fMemoryLimit);
+	msg.AddInt32("eviction", fEviction);
+	msg.AddInt32("spillthreshold", fSpillThreshold);
+	msg.AddInt32("autopaste", fAutoPaste);
+	msg.AddInt32("pastedelay", fPasteDelay);
+	msg.AddInt32("fade", fFade);
+	msg.AddInt32("fadedelay", fFadeDelay);
+	msg.AddInt32("fadestep", fFadeStep);
+	msg.AddInt32("fademax", fFadeMaxLevel);
+	msg.AddInt32("coalescequiet", fCoalesceQuiet);
+	msg.AddInt32("coalescelatency", fCoalesceLatency);
+	msg.AddRect("windowlocation", fPosition);
+	msg.AddFloat("split_weight_left", fLeftWeight);
+	msg.AddFloat("split_weight_right", fRightWeight);
+	msg.AddBool("split_collapse_left", fLeftCollapse);
+	msg.AddBool("split_collapse_right", fRightCollapse);
+
+	atomic_set(&fSaving, 1);
+	if (!wait) {
+		fSaveThread = spawn_thread(_WriteSettings, "settings writer",
+			B_LOW_PRIORITY, job);
+		if (fSaveThread >= 0)
+			return resume_thread(fSaveThread);
 	}
+	return _WriteSettings(job);
 }
 
 
-bool
-ClipdingerSettings::Lock()
+/*static*/ status_t
+ClipdingerSettings::_WriteSettings(void* data)
 {
-	return fLock.Lock();
+	settings_job* job = (settings_job*)data;
+	bigtime_t start = system_time();
+
+	// write to a temporary file first, so a crash can't leave us with
+	// a half written settings file
+	BString tempPath(job->path.Path());
+	tempPath.Append("~");
+
+	BFile file(tempPath.String(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	status_t ret = file.InitCheck();
+	if (ret == B_OK)
+		ret = job->settings.Flatten(&file);
+	if (ret == B_OK)
+		ret = file.Sync();
+	file.Unset();
+
+	BEntry entry(tempPath.String());
+	if (ret == B_OK)
+		ret = entry.Rename(job->path.Path(), true);
+	ClipdingerSettings* owner = job->owner;
+	if (ret == B_OK) {
+		bigtime_t latency = system_time() - start;
+		atomic_set(job->savedChanges, job->changes);
+		atomic_add64(&owner->fSaves, 1);
+		atomic_set64(&owner->fLastSaveLatency, latency);
+		if (latency > atomic_get64(&owner->fMaxSaveLatency))
+			atomic_set64(&owner->fMaxSaveLatency, latency);
+		atomic_set64(&owner->fLastSaveBytes, job->settings.FlattenedSize());
+	} else {
+		atomic_add64(&owner->fSaveFailures, 1);
+		entry.Remove();
+	}
+
+	atomic_set(job->saving, 0);
+	delete job;
+	return ret;
 }
 
 
 void
-ClipdingerSettings::Unlock()
+ClipdingerSettings::GetSaveCounters(int64* saves, int64* failures,
+	int64* lastLatency, int64* maxLatency, int64* lastBytes)
 {
-	fLock.Unlock();
+	*saves = atomic_get64(&fSaves);
+	*failures = atomic_get64(&fSaveFailures);
+	*lastLatency = atomic_get64(&fLastSaveLatency);
+	*maxLatency = atomic_get64(&fMaxSaveLatency);
+	*lastBytes = atomic_get64(&fLastSaveBytes);
 }
 
 
@@ -157,7 +286,37 @@ ClipdingerSettings::SetLimit(int32 limit)
 	if (fLimit == limit)
 		return;
 	fLimit = limit;
-	dirtySettings = true;
+	fChanges++;
+}
+
+
+void
+ClipdingerSettings::SetMemoryLimit(int32 limit)
+{
+	if (fMemoryLimit == limit)
+		return;
+	fMemoryLimit = limit;
+	fChanges++;
+}
+
+
+void
+ClipdingerSettings::SetEviction(int32 policy)
+{
+	if (fEviction == policy)
+		return;
+	fEviction = policy;
+	fChanges++;
+}
+
+
+void
+ClipdingerSettings::SetSpillThreshold(int32 threshold)
+{
+	if (fSpillThreshold == threshold)
+		return;
+	fSpillThreshold = threshold;
+	fChanges++;
 }
 
 
@@ -167,7 +326,17 @@ ClipdingerSettings::SetAutoPaste(int32 autopaste)
 	if (fAutoPaste == autopaste)
 		return;
 	fAutoPaste = autopaste;
-	dirtySettings = true;
+	fChanges++;
+}
+
+
+void
+ClipdingerSettings::SetPasteDelay(int32 delay)
+{
+	if (fPasteDelay == delay)
+		return;
+	fPasteDelay = delay;
+	fChanges++;
 }
 
 
@@ -177,7 +346,7 @@ ClipdingerSettings::SetFade(int32 fade)
 	if (fFade == fade)
 		return;
 	fFade = fade;
-	dirtySettings = true;
+	fChanges++;
 }
 
 
@@ -187,7 +356,7 @@ ClipdingerSettings::SetFadeDelay(int32 delay)
 	if (fFadeDelay == delay)
 		return;
 	fFadeDelay = delay;
-	dirtySettings = true;
+	fChanges++;
 }
 
 
@@ -197,7 +366,7 @@ ClipdingerSettings::SetFadeStep(int32 step)
 	if (fFadeStep == step)
 		return;
 	fFadeStep = step;
-	dirtySettings = true;
+	fChanges++;
 }
 
 
@@ -207,7 +376,18 @@ ClipdingerSettings::SetFadeMaxLevel(int32 level)
 	if (fFadeMaxLevel == level)
 		return;
 	fFadeMaxLevel = level;
-	dirtySettings = true;
+	fChanges++;
+}
+
+
+void
+ClipdingerSettings::SetCoalescing(int32 quiet, int32 latency)
+{
+	if (fCoalesceQuiet == quiet && fCoalesceLatency == latency)
+		return;
+	fCoalesceQuiet = quiet;
+	fCoalesceLatency = latency;
+	fChanges++;
 }
 
 
@@ -217,7 +397,7 @@ ClipdingerSettings::SetWindowPosition(BRect where)
 	if (fPosition == where)
 		return;
 	fPosition = where;
-	dirtySettings = true;
+	fChanges++;
 }
 
 
@@ -228,7 +408,7 @@ ClipdingerSettings::SetSplitWeight(float left, float right)
 		return;
 	fLeftWeight = left;
 	fRightWeight = right;
-	dirtySettings = true;
+	fChanges++;
 }
 
 
@@ -239,5 +419,5 @@ ClipdingerSettings::SetSplitCollapse(bool left, bool right)
 		return;
 	fLeftCollapse = left;
 	fRightCollapse = right;
-	dirtySettings = true;
+	fChanges++;
 }
@@ -10,6 +10,7 @@
 #define CLIPDINGERSETTINGS_H
 
 #include <Locker.h>
+#include <OS.h>
 #include <Rect.h>
 
 
@@ -20,44 +21,78 @@ public:
 
 		bool		Lock();
 		void		Unlock();
+
+		status_t	Save(bool wait = false);
+		// of the settings writer, latencies are in microseconds
+		void		GetSaveCounters(int64* saves, int64* failures,
+						int64* lastLatency, int64* maxLatency,
+						int64* lastBytes);
 			
 		int32		GetLimit() { return fLimit; }
+		int32		GetMemoryLimit() { return fMemoryLimit; }
+		int32		GetEviction() { return fEviction; }
+		int32		GetSpillThreshold() { return fSpillThreshold; }
 		int32		GetAutoPaste() { return fAutoPaste; }
+		int32		GetPasteDelay() { return fPasteDelay; }
 		int32		GetFade() { return fFade; }
 		int32		GetFadeDelay() { return fFadeDelay; }
 		int32		GetFadeStep() { return fFadeStep; }
 		int32		GetFadeMaxLevel() { return fFadeMaxLevel; }
 		int32		GetFadePause() { return fFadePause; }
+		int32		GetCoalesceQuiet() { return fCoalesceQuiet; }
+		int32		GetCoalesceLatency() { return fCoalesceLatency; }
 		BRect		GetWindowPosition() { return fPosition; }
 		void		GetSplitWeight(float* left, float* right);
 		void		GetSplitCollapse(bool* left, bool* right);
 
 		void		SetLimit(int32 limit);
+		void		SetMemoryLimit(int32 limit);
+		void		SetEviction(int32 policy);
+		void		SetSpillThreshold(int32 threshold);
 		void		SetAutoPaste(int32 autopaste);
+		void		SetPasteDelay(int32 delay);
 		void		SetFade(int32 fade);
 		void		SetFadeDelay(int32 delay);
 		void		SetFadeStep(int32 step);
 		void		SetFadeMaxLevel(int32 level);
+		void		SetCoalescing(int32 quiet, int32 latency);
 		void		SetWindowPosition(BRect where);
 		void		SetSplitWeight(float left, float right);
 		void		SetSplitCollapse(bool left, bool right);
 		void		SetFadePause(int32 pause) { fFadePause = pause; }
 private:
+static	status_t	_WriteSettings(void* data);
+
 		int32		fLimit;
+		int32		fMemoryLimit;
+		int32		fEviction;
+		int32		fSpillThreshold;
 		int32		fAutoPaste;
+		int32		fPasteDelay;
 		int32		fFade;
 		int32		fFadeDelay;
 		int32		fFadeStep;
 		int32		fFadeMaxLevel;
 		int32		fFadePause;
+		int32		fCoalesceQuiet;
+		int32		fCoalesceLatency;
 		BRect		fPosition;
 		float		fLeftWeight;
 		float		fRightWeight;
 		bool		fLeftCollapse;
 		bool		fRightCollapse;
 
-		bool		dirtySettings;;
-		
+		// changes made, and how many of them made it to disk
+		int32		fChanges;
+		int32		fSavedChanges;
+		thread_id	fSaveThread;
+		int32		fSaving;
+		int64		fSaves;
+		int64		fSaveFailures;
+		int64		fLastSaveLatency;
+		int64		fMaxSaveLatency;
+		int64		fLastSaveBytes;
+
 		BLocker		fLock;
 };
 
@@ -9,23 +9,46 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
-#define OUTPUT_PORT_NAME	"Clipdinger output port"
-
-static const char *kApplicationSignature = "application/x-vnd.Clipdinger";
+static const char kApplicationSignature[] = "application/x-vnd.Clipdinger";
 static const char kSettingsFolder[] = "Clipdinger";
 static const char kSettingsFile[] = "Clipdinger_settings";
 static const char kHistoryFile[] = "Clipdinger_history";
+static const char kHistoryJournalFile[] = "Clipdinger_history_journal";
+static const char kHistoryOldJournalFile[] = "Clipdinger_history_journal.old";
+static const char kHistoryPendingJournalFile[]
+	= "Clipdinger_history_journal.pending";
 static const char kFavoriteFile[] = "Clipdinger_favorites";
+static const char kSpillFolder[] = "Clipdinger_clips";
+static const char kIconCacheFile[] = "Clipdinger_icons";
 
 static const int32 kDefaultLimit = 100;
+static const int32 kDefaultMemoryLimit = 64; // MiB
+static const int32 kDefaultEviction = 0; // kEvictOldest
+static const int32 kDefaultSpillThreshold = 16; // MiB
 static const int32 kDefaultAutoPaste = 1;
+// ms the clipboard stays with a clip of a paste sequence when the input
+// device doesn't answer its paste, as older ones don't
+static const int32 kDefaultPasteDelay = 250;
 static const int32 kDefaultFade = 0;
 static const int32 kDefaultFadeDelay = 6;
 static const int32 kDefaultFadeStep = 5;
 static const int32 kDefaultFadeMaxLevel = 8;
+static const int32 kDefaultCoalesceQuiet = 150; // ms without another change
+static const int32 kDefaultCoalesceLatency = 1000; // ms at most
 static const int32 kIconSize = 16;
 static const int32 kMaxTitleChars = 100;
+static const float kTitleWidthBucket = 8; // pixels, title widths are rounded down to
+static const size_t kCompressThreshold = 64 * 1024; // bytes
 static const int32 kMinuteUnits = 10; // minutes per unit
+static const bigtime_t kCompactInterval = 60000000; // check every minute
+static const bigtime_t kAutosaveDelay = 3000000; // after the last change
+static const int32 kLoadBatchSize = 256; // clips per background load batch
+static const int32 kMaxFilterResults = 500; // best matches shown per list
+// the input device keeps the clipboard for the target that long after an
+// auto-paste, more the busier the system is
+static const bigtime_t kMinPasteGap = 10000;
+static const bigtime_t kMaxPasteGap = 100000;
+static const bigtime_t kPasteRequestTimeout = 100000;
 
 #define DELETE				'dele'
 #define FAV_DELETE			'delf'
@@ -47,6 +70,16 @@ static const int32 kMinuteUnits = 10; // minutes per unit
 #define PAUSE				'paus'
 #define SETTINGS			'sett'
 #define SWITCHLIST			'swls'
+#define COMPACT_HISTORY		'cmph'
+#define AUTOSAVE			'asav'
+#define HISTORY_LOADED		'hlod'
+#define FILTER				'filt'
+#define FILTER_TYPED		'ftyp'
+#define CLIP_INGESTED		'cing'
+#define INGEST_CHECK		'ichk'
+#define PASTE_DONE			'pdon'
+#define PASTE_SEQUENCE		'pseq'
+#define PASTE_TIMEOUT		'ptmo'
 
 #define	AUTOPASTE			'auto'
 #define FADE				'fade'
@@ -55,6 +88,7 @@ static const int32 kMinuteUnits = 10; // minutes per unit
 #define LEVEL				'levl'
 #define CANCEL				'cncl'
 #define OK					'okay'
+#define EVICTION			'evic'
 #define UPDATE_SETTINGS		'uset'
 
 #endif //CONSTANTS_H
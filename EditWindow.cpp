@@ -20,15 +20,14 @@
 #define B_TRANSLATION_CONTEXT "EditWindow"
 
 
-EditWindow::EditWindow(BRect frame, FavItem* fav)
+EditWindow::EditWindow(BRect frame, const BString& title)
 	:
 	BWindow(BRect(), B_TRANSLATE("Edit title"),
 		B_MODAL_WINDOW,
 		B_NOT_ZOOMABLE | B_AUTO_UPDATE_SIZE_LIMITS |
 		B_CLOSE_ON_ESCAPE)
 {
-	fItem = fav;
-	originalTitle = fav->GetTitle();
+	originalTitle = title;
 	
 	_BuildLayout();
 
@@ -87,12 +86,10 @@ EditWindow::MessageReceived(BMessage* message)
 		}
 		case OK:
 		{
-			BString title = fTitleControl->Text();
-			fItem->SetTitle(title);
-			fItem->SetDisplayTitle(title);
-
+			// the favorite belongs to the main window, and may be gone
 			BMessenger messenger(my_app->fMainWindow);
 			BMessage message(UPDATE_FAV_DISPLAY);
+			message.AddString("title", fTitleControl->Text());
 			messenger.SendMessage(&message);
 
 			Quit();
@@ -12,12 +12,12 @@
 #include <TextControl.h>
 #include <Window.h>
 
-#include "FavItem.h"
+#include <String.h>
 
 
 class EditWindow : public BWindow {
 public:
-					EditWindow(BRect frame, FavItem* fav);
+					EditWindow(BRect frame, const BString& title);
 	virtual			~EditWindow();
 
 	void			MessageReceived(BMessage* message);
@@ -25,7 +25,6 @@ public:
 
 private:
 	BTextControl*	fTitleControl;
-	FavItem*		fItem;
 	BString			originalTitle;
 };
 
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include "ClipItem.h"
+#include "EvictionPolicy.h"
+
+
+class OldestFirstPolicy : public EvictionPolicy {
+public:
+	virtual bool Prefers(ClipItem* candidate, ClipItem* current) const
+	{
+		return candidate->GetTimeAdded() < current->GetTimeAdded();
+	}
+};
+
+
+class LargestFirstPolicy : public EvictionPolicy {
+public:
+	virtual bool Prefers(ClipItem* candidate, ClipItem* current) const
+	{
+		size_t candidateSize = candidate->GetClipData()->StoredLength();
+		size_t currentSize = current->GetClipData()->StoredLength();
+		if (candidateSize != currentSize)
+			return candidateSize > currentSize;
+		return candidate->GetTimeAdded() < current->GetTimeAdded();
+	}
+};
+
+
+class LeastPastedPolicy : public EvictionPolicy {
+public:
+	virtual bool Prefers(ClipItem* candidate, ClipItem* current) const
+	{
+		if (candidate->GetPasteCount() != current->GetPasteCount())
+			return candidate->GetPasteCount() < current->GetPasteCount();
+		return candidate->GetTimeAdded() < current->GetTimeAdded();
+	}
+};
+
+
+EvictionPolicy::~EvictionPolicy()
+{
+}
+
+
+/*static*/ EvictionPolicy*
+EvictionPolicy::Create(int32 policy)
+{
+	switch (policy) {
+		case kEvictLargest:
+			return new LargestFirstPolicy;
+		case kEvictLeastPasted:
+			return new LeastPastedPolicy;
+		case kEvictOldest:
+		default:
+			return new OldestFirstPolicy;
+	}
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef EVICTIONPOLICY_H
+#define EVICTIONPOLICY_H
+
+#include <SupportDefs.h>
+
+class ClipItem;
+
+enum {
+	kEvictOldest = 0,
+	kEvictLargest,
+	kEvictLeastPasted
+};
+
+
+// Decides which history clip has to go first, when the history takes
+// up more memory than it may.
+class EvictionPolicy {
+public:
+	virtual					~EvictionPolicy();
+
+	// true if the candidate should be evicted rather than the current pick
+	virtual bool			Prefers(ClipItem* candidate,
+								ClipItem* current) const = 0;
+
+	static EvictionPolicy*	Create(int32 policy);
+};
+
+#endif // EVICTIONPOLICY_H
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <InterfaceDefs.h>
+
+#include "ClipItem.h"
+#include "FadeSchedule.h"
+
+
+FadeSchedule::FadeSchedule()
+	:
+	fDelay(0)
+{
+	fPalette.push_back(ui_color(B_LIST_BACKGROUND_COLOR));
+}
+
+
+bool
+FadeSchedule::SetSettings(bool fade, int32 delay, int32 steps, float maxLevel)
+{
+	std::vector<rgb_color> palette;
+	rgb_color background = ui_color(B_LIST_BACKGROUND_COLOR);
+	palette.push_back(background);
+
+	// the full tint is reached after the last step
+	if (fade && delay > 0 && steps > 0) {
+		for (int32 step = 1; step <= steps; step++) {
+			palette.push_back(tint_color(background,
+				B_NO_TINT + (maxLevel - B_NO_TINT) * step / steps));
+		}
+	}
+
+	int32 seconds = palette.size() > 1 ? delay * 60 : 0;
+	if (palette.size() == fPalette.size() && seconds == fDelay) {
+		bool same = true;
+		for (size_t i = 0; same && i < palette.size(); i++)
+			same = palette[i] == fPalette[i];
+		if (same)
+			return false;
+	}
+
+	fPalette.swap(palette);
+	fDelay = seconds;
+	return true;
+}
+
+
+bool
+FadeSchedule::Add(ClipItem* item, int32 now)
+{
+	Remove(item);
+
+	int32 last = fPalette.size() - 1;
+	int32 step = 0;
+	if (fDelay > 0 && now > item->GetTimeAdded())
+		step = (now - item->GetTimeAdded()) / fDelay;
+	if (step > last)
+		step = last;
+
+	if (step < last) {
+		int32 deadline = item->GetTimeAdded() + (step + 1) * fDelay;
+		item->SetFadeDeadline(deadline);
+		fQueue.insert(fade_deadline(deadline, item));
+	}
+
+	return item->SetColor(fPalette[step]);
+}
+
+
+void
+FadeSchedule::Remove(ClipItem* item)
+{
+	if (item->GetFadeDeadline() == 0)
+		return;
+
+	fQueue.erase(fade_deadline(item->GetFadeDeadline(), item));
+	item->SetFadeDeadline(0);
+}
+
+
+void
+FadeSchedule::MakeEmpty()
+{
+	std::set<fade_deadline>::iterator iterator = fQueue.begin();
+	for (; iterator != fQueue.end(); iterator++)
+		iterator->second->SetFadeDeadline(0);
+	fQueue.clear();
+}
+
+
+void
+FadeSchedule::Advance(int32 now, BList& changed)
+{
+	while (!fQueue.empty() && fQueue.begin()->first <= now) {
+		ClipItem* item = fQueue.begin()->second;
+		if (Add(item, now))
+			changed.AddItem(item);
+	}
+}
+
+
+int32
+FadeSchedule::NextDeadline() const
+{
+	return fQueue.empty() ? 0 : fQueue.begin()->first;
+}
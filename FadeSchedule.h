@@ -0,0 +1,52 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef FADESCHEDULE_H
+#define FADESCHEDULE_H
+
+#include <GraphicsDefs.h>
+#include <List.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+class ClipItem;
+
+
+// Fades the history clips step by step as they get older. The tints of
+// all steps are worked out once per settings change, and each clip is
+// queued with the time it reaches its next step, so a tick only has to
+// look at the clips whose tint actually changes.
+class FadeSchedule {
+public:
+							FadeSchedule();
+
+	// the delay is in minutes per step, true if the tints changed
+	bool					SetSettings(bool fade, int32 delay, int32 steps,
+								float maxLevel);
+
+	// sets the clip's tint and queues it for its next step
+	bool					Add(ClipItem* item, int32 now);
+	void					Remove(ClipItem* item);
+	void					MakeEmpty();
+
+	// moves on all clips that are due, and adds those that look different
+	void					Advance(int32 now, BList& changed);
+	// 0 if no clip will fade any further
+	int32					NextDeadline() const;
+
+private:
+	typedef std::pair<int32, ClipItem*> fade_deadline;
+
+	std::set<fade_deadline>	fQueue;
+	std::vector<rgb_color>	fPalette;
+	int32					fDelay;		// seconds per step
+};
+
+#endif // FADESCHEDULE_H
@@ -15,26 +15,26 @@
 #include "Constants.h"
 
 
-FavItem::FavItem(BString clip, BString title, int32 favnumber)
+FavItem::FavItem(ClipData* clip, const BString& title, int32 favnumber)
 	:
 	BListItem()
 {
 	fClip = clip;
+	fClip->AcquireReference();
 	fFavNumber = favnumber;
-	if (title != NULL)
-		fDisplayTitle = title;
-	else if (fClip.CountChars() > kMaxTitleChars) {
-		fClip.CopyInto(fDisplayTitle, 0, kMaxTitleChars);
-		fDisplayTitle.Append(B_UTF8_ELLIPSIS);
-	} else
-		fDisplayTitle = fClip;
-
-	fTitle = fDisplayTitle;
+	if (!title.IsEmpty())
+		fTitle = title;
+	else {
+		fClip->GetTitle(fTitle);
+		if ((size_t)fTitle.Length() < fClip->Length())
+			fTitle.Append(B_UTF8_ELLIPSIS);
+	}
 }
 
 
 FavItem::~FavItem()
 {
+	fClip->ReleaseReference();
 }
 
 
@@ -91,7 +91,9 @@ FavItem::DrawItem(BView *view, BRect rect, bool complete)
 	font.SetFace(B_REGULAR_FACE);
 	view->SetFont(&font);
 
-    view->DrawString(fDisplayTitle.String(), BPoint(spacing * 3 + Fnwidth,
+	float width = rect.Width() - Fnwidth - spacing * 4;
+    view->DrawString(fDisplayTitle.Get(fTitle, font, width).String(),
+		BPoint(spacing * 3 + Fnwidth,
 		rect.top + fheight.ascent + fheight.descent + fheight.leading));
 
 	// draw lines
@@ -102,22 +104,3 @@ FavItem::DrawItem(BView *view, BRect rect, bool complete)
 		BPoint(spacing * 2 + Fnwidth, rect.bottom));
 }
 
-
-void
-FavItem::Update(BView* view, const BFont* finfo)
-{
-	// we need to DefaultLabelSpacing the update method so we can make sure the
-	// list item size doesn't change
-	BListItem::Update(view, finfo);
-
-	static const float spacing = be_control_look->DefaultLabelSpacing();
-	BString string(GetTitle());
-	view->TruncateString(&string, B_TRUNCATE_END, Width()- spacing * 4);
-	SetDisplayTitle(string);
-
-	font_height	fheight;
-	finfo->GetHeight(&fheight);
-
-	SetHeight(ceilf(fheight.ascent + 2 + fheight.leading / 2
-		+ fheight.descent) + 5);
-}
@@ -14,25 +14,27 @@
 #include <ListItem.h>
 #include <String.h>
 
+#include "ClipData.h"
+#include "TruncatedTitle.h"
 
 class FavItem : public BListItem {
 public:
-					FavItem(BString clip, BString title, int32 favnumber);
+					FavItem(ClipData* clip, const BString& title,
+						int32 favnumber);
 					~FavItem();
 
-	BString			GetClip() { return fClip; };
-	BString			GetTitle() { return fTitle; };
-	void			SetTitle(BString title) { fTitle = title; };
-	void			SetDisplayTitle(BString display) { fDisplayTitle = display; };
+	ClipData*		GetClipData() { return fClip; };
+	const BString&	GetTitle() { return fTitle; };
+	void			SetTitle(BString title)
+						{ fTitle = title; fDisplayTitle.Invalidate(); };
 	void			SetFavNumber(int32 number) { fFavNumber = number; };
 
 	virtual void	DrawItem(BView* view, BRect rect, bool complete);
-	virtual	void	Update(BView* view, const BFont* finfo);
 
 private:
-	BString			fClip;
-	BString			fDisplayTitle;
+	ClipData*		fClip;
 	BString			fTitle;
+	TruncatedTitle	fDisplayTitle;
 	int32			fFavNumber;
 };
 
@@ -21,7 +21,7 @@
 
 FavView::FavView(const char* name)
 	:
-	BListView(name)
+	VirtualListView(name)
 {
 }
 
@@ -31,46 +31,6 @@ FavView::~FavView()
 }
 
 
-void
-FavView::AttachedToWindow()
-{
-	SetFlags(Flags() | B_FULL_UPDATE_ON_RESIZE | B_NAVIGABLE);
-
-	BListView::AttachedToWindow();
-}
-
-
-void
-FavView::FrameResized(float width, float height)
-{
-	BListView::FrameResized(width, height);
-
-	static const float spacing = be_control_look->DefaultLabelSpacing();
-
-	for (int32 i = 0; i < CountItems(); i++) {
-		FavItem *sItem = dynamic_cast<FavItem *> (ItemAt(i));
-		BString string(sItem->GetTitle());
-		TruncateString(&string, B_TRUNCATE_END, width - kIconSize
-			- spacing * 4);
-		sItem->SetDisplayTitle(string);
-	}
-}
-
-
-void
-FavView::Draw(BRect rect)
-{
-	SetHighColor(ui_color(B_CONTROL_BACKGROUND_COLOR));
-
-	BRect bounds(Bounds());
-	BRect itemFrame = ItemFrame(CountItems() - 1);
-	bounds.top = itemFrame.bottom;
-	FillRect(bounds);
-
-	BListView::Draw(rect);
-}
-
-
 void
 FavView::MessageReceived(BMessage* message)
 {
@@ -82,7 +42,7 @@ FavView::MessageReceived(BMessage* message)
 		}
 		default:
 		{
-			BListView::MessageReceived(message);
+			VirtualListView::MessageReceived(message);
 			break;
 		}
 	}
@@ -106,9 +66,24 @@ FavView::KeyDown(const char* bytes, int32 numBytes)
 			Looper()->PostMessage(&message);
 			break;
 		}
+		case B_BACKSPACE:
+		{
+			BMessage message(FILTER_TYPED);
+			message.AddString("bytes", bytes);
+			Looper()->PostMessage(&message);
+			break;
+		}
 		default:
 		{
-			BListView::KeyDown(bytes, numBytes);
+			// typing filters the lists, a space as well
+			if ((uint8)bytes[0] >= B_SPACE
+				&& (modifiers() & B_COMMAND_KEY) == 0) {
+				BMessage message(FILTER_TYPED);
+				message.AddString("bytes", bytes);
+				Looper()->PostMessage(&message);
+				break;
+			}
+			VirtualListView::KeyDown(bytes, numBytes);
 			break;
 		}
 	}
@@ -133,7 +108,7 @@ FavView::MouseDown(BPoint position)
 		if (buttons == B_SECONDARY_MOUSE_BUTTON)
 			ShowPopUpMenu(ConvertToScreen(position));
 	}
-	BListView::MouseDown(position);
+	VirtualListView::MouseDown(position);
 }
 
 
@@ -0,0 +1,391 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <BufferIO.h>
+#include <File.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <map>
+
+#include "ClipStore.h"
+#include "HistoryFile.h"
+
+static const uint32 kHistoryFileMagic = 'CDhf';
+static const uint32 kHistoryFileVersion = 4;
+
+enum {
+	kClipCompressed = 0x01,
+	kClipSpilled	= 0x02	// the text is in a file of its own
+};
+
+// All values are in host byte order. The header is followed by the table
+// of clips, then the table of entries: first the history, newest clip
+// first, then the favorites in their order. Entries point to their
+// origin and title, which are stored back to back in the data area,
+// and refer to their clip by its index in the clip table.
+struct history_file_header {
+	uint32				magic;
+	uint32				version;
+	int32				generation;
+	int32				quitTime;
+	uint32				clipCount;
+	uint32				historyCount;
+	uint32				favoriteCount;
+	uint32				reserved;
+};
+
+struct history_file_clip {
+	clip_digest			digest;
+	uint64				offset;
+	uint64				length;
+	uint64				storedLength;
+	uint32				flags;
+	uint32				reserved;
+};
+
+// version 2 didn't know compressed clips
+struct history_file_clip_v2 {
+	clip_digest			digest;
+	uint64				offset;
+	uint64				length;
+};
+
+struct history_file_entry {
+	uint32				clip;
+	uint32				originLength;
+	uint32				titleLength;
+	int32				time;
+	uint64				offset;
+	uint32				pasteCount;
+	uint32				reserved;
+};
+
+// versions 2 and 3 didn't count pastes
+struct history_file_entry_v3 {
+	uint32				clip;
+	uint32				originLength;
+	uint32				titleLength;
+	int32				time;
+	uint64				offset;
+};
+
+
+history_entry::history_entry()
+	:
+	clip(NULL),
+	time(0),
+	pasteCount(0)
+{
+}
+
+
+history_entry::~history_entry()
+{
+	if (clip != NULL)
+		clip->ReleaseReference();
+}
+
+
+//	#pragma mark -
+
+
+HistoryFile::HistoryFile()
+	:
+	fAddress(NULL),
+	fSize(0)
+{
+}
+
+
+HistoryFile::~HistoryFile()
+{
+	_Unset();
+}
+
+
+status_t
+HistoryFile::SetTo(const char* path)
+{
+	_Unset();
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return B_ENTRY_NOT_FOUND;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(history_file_header)) {
+		close(fd);
+		return B_BAD_DATA;
+	}
+
+	void* address = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (address == MAP_FAILED)
+		return B_NO_MEMORY;
+
+	fAddress = address;
+	fSize = st.st_size;
+
+	const history_file_header* header = (history_file_header*)fAddress;
+	uint64 tables = sizeof(history_file_header)
+		+ (uint64)header->clipCount * _ClipRecordSize()
+		+ ((uint64)header->historyCount + header->favoriteCount)
+			* _EntryRecordSize();
+	if (header->magic != kHistoryFileMagic
+		|| header->version < 2 || header->version > kHistoryFileVersion
+		|| tables > fSize) {
+		_Unset();
+		return B_BAD_DATA;
+	}
+	return B_OK;
+}
+
+
+int32
+HistoryFile::Generation() const
+{
+	return fAddress != NULL ? ((history_file_header*)fAddress)->generation : 0;
+}
+
+
+int32
+HistoryFile::QuitTime() const
+{
+	return fAddress != NULL ? ((history_file_header*)fAddress)->quitTime : 0;
+}
+
+
+status_t
+HistoryFile::GetEntries(ClipStore* store, BList* history, BList* favorites)
+{
+	if (fAddress == NULL)
+		return B_NO_INIT;
+
+	const char* base = (const char*)fAddress;
+	const history_file_header* header = (history_file_header*)base;
+	const char* clipTable = base + sizeof(history_file_header);
+	const char* entryTable = clipTable
+		+ header->clipCount * _ClipRecordSize();
+
+	BList clips(header->clipCount);
+	status_t status = B_OK;
+	for (uint32 i = 0; i < header->clipCount; i++) {
+		// version 2 records are a prefix of the current ones
+		const history_file_clip* fileClip
+			= (history_file_clip*)(clipTable + i * _ClipRecordSize());
+		uint64 storedLength = fileClip->length;
+		uint32 flags = 0;
+		if (header->version != 2) {
+			storedLength = fileClip->storedLength;
+			flags = fileClip->flags;
+		}
+		if (fileClip->offset > fSize
+			|| storedLength > fSize - fileClip->offset) {
+			status = B_BAD_DATA;
+			break;
+		}
+
+		ClipData* clip;
+		if ((flags & kClipSpilled) != 0)
+			clip = store->InternSpilled(fileClip->length, fileClip->digest);
+		else {
+			clip = store->Intern(new ClipData(this, base + fileClip->offset,
+				storedLength, fileClip->length,
+				(flags & kClipCompressed) != 0, fileClip->digest));
+		}
+		if (clip == NULL) {
+			status = B_NO_INIT;
+			break;
+		}
+		clips.AddItem(clip);
+	}
+
+	uint32 count = header->historyCount + header->favoriteCount;
+	for (uint32 i = 0; status == B_OK && i < count; i++) {
+		// older records are a prefix of the current ones as well
+		const history_file_entry* fileEntry
+			= (history_file_entry*)(entryTable + i * _EntryRecordSize());
+		uint64 length = (uint64)fileEntry->originLength
+			+ fileEntry->titleLength;
+		if (fileEntry->clip >= (uint32)clips.CountItems()
+			|| fileEntry->offset > fSize
+			|| length > fSize - fileEntry->offset) {
+			status = B_BAD_DATA;
+			break;
+		}
+
+		const char* data = base + fileEntry->offset;
+		history_entry* entry = new history_entry;
+		entry->origin.SetTo(data, fileEntry->originLength);
+		entry->title.SetTo(data + fileEntry->originLength,
+			fileEntry->titleLength);
+		entry->clip = (ClipData*)clips.ItemAt(fileEntry->clip);
+		entry->clip->AcquireReference();
+		entry->time = fileEntry->time;
+		if (header->version >= 4)
+			entry->pasteCount = fileEntry->pasteCount;
+
+		if (i < header->historyCount)
+			history->AddItem(entry);
+		else
+			favorites->AddItem(entry);
+	}
+
+	for (int32 i = 0; i < clips.CountItems(); i++)
+		((ClipData*)clips.ItemAt(i))->ReleaseReference();
+	return status;
+}
+
+
+/*static*/ status_t
+HistoryFile::Write(const char* path, BList* history, BList* favorites,
+	int32 generation, int32 quitTime)
+{
+	BFile file(path, B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	status_t status = file.InitCheck();
+	if (status != B_OK)
+		return status;
+
+	// give every distinct clip an index, shared clips are interned
+	// and therefore the same object
+	std::map<ClipData*, uint32> indices;
+	BList clips;
+	BList entries(*history);
+	entries.AddList(favorites);
+
+	uint64 stringsSize = 0;
+	for (int32 i = 0; i < entries.CountItems(); i++) {
+		history_entry* entry = (history_entry*)entries.ItemAt(i);
+		if (indices.find(entry->clip) == indices.end()) {
+			indices[entry->clip] = clips.CountItems();
+			clips.AddItem(entry->clip);
+		}
+		stringsSize += entry->origin.Length() + entry->title.Length();
+	}
+
+	BBufferIO buffer(&file, 65536, false);
+
+	history_file_header header;
+	header.magic = kHistoryFileMagic;
+	header.version = kHistoryFileVersion;
+	header.generation = generation;
+	header.quitTime = quitTime;
+	header.clipCount = clips.CountItems();
+	header.historyCount = history->CountItems();
+	header.favoriteCount = favorites->CountItems();
+	header.reserved = 0;
+	if (buffer.Write(&header, sizeof(header)) != sizeof(header))
+		return B_IO_ERROR;
+
+	// titles and origins come right after the tables, the clip texts last
+	uint64 stringOffset = sizeof(header)
+		+ (uint64)header.clipCount * sizeof(history_file_clip)
+		+ (uint64)entries.CountItems() * sizeof(history_file_entry);
+	uint64 clipOffset = stringOffset + stringsSize;
+
+	for (int32 i = 0; i < clips.CountItems(); i++) {
+		ClipData* clip = (ClipData*)clips.ItemAt(i);
+
+		history_file_clip fileClip;
+		fileClip.digest = clip->Digest();
+		fileClip.offset = clipOffset;
+		fileClip.length = clip->Length();
+		fileClip.storedLength = clip->StoredLength();
+		fileClip.flags = 0;
+		if (clip->IsCompressed())
+			fileClip.flags |= kClipCompressed;
+		if (clip->IsSpilled())
+			fileClip.flags |= kClipSpilled;
+		fileClip.reserved = 0;
+		if (buffer.Write(&fileClip, sizeof(fileClip)) != sizeof(fileClip))
+			return B_IO_ERROR;
+
+		clipOffset += fileClip.storedLength;
+	}
+
+	for (int32 i = 0; i < entries.CountItems(); i++) {
+		history_entry* entry = (history_entry*)entries.ItemAt(i);
+
+		history_file_entry fileEntry;
+		fileEntry.clip = indices[entry->clip];
+		fileEntry.originLength = entry->origin.Length();
+		fileEntry.titleLength = entry->title.Length();
+		fileEntry.time = entry->time;
+		fileEntry.offset = stringOffset;
+		fileEntry.pasteCount = entry->pasteCount;
+		fileEntry.reserved = 0;
+		if (buffer.Write(&fileEntry, sizeof(fileEntry)) != sizeof(fileEntry))
+			return B_IO_ERROR;
+
+		stringOffset += fileEntry.originLength + fileEntry.titleLength;
+	}
+
+	for (int32 i = 0; i < entries.CountItems(); i++) {
+		history_entry* entry = (history_entry*)entries.ItemAt(i);
+		if (buffer.Write(entry->origin.String(), entry->origin.Length())
+				!= entry->origin.Length()
+			|| buffer.Write(entry->title.String(), entry->title.Length())
+				!= entry->title.Length())
+			return B_IO_ERROR;
+	}
+
+	for (int32 i = 0; i < clips.CountItems(); i++) {
+		ClipData* clip = (ClipData*)clips.ItemAt(i);
+		if (buffer.Write(clip->StoredData(), clip->StoredLength())
+				!= (ssize_t)clip->StoredLength())
+			return B_IO_ERROR;
+	}
+
+	status = buffer.Flush();
+	if (status == B_OK)
+		status = file.Sync();
+	return status;
+}
+
+
+/*static*/ void
+HistoryFile::EmptyEntries(BList* entries)
+{
+	for (int32 i = 0; i < entries->CountItems(); i++)
+		delete (history_entry*)entries->ItemAt(i);
+	entries->MakeEmpty();
+}
+
+
+size_t
+HistoryFile::_ClipRecordSize() const
+{
+	if (((history_file_header*)fAddress)->version == 2)
+		return sizeof(history_file_clip_v2);
+	return sizeof(history_file_clip);
+}
+
+
+size_t
+HistoryFile::_EntryRecordSize() const
+{
+	if (((history_file_header*)fAddress)->version < 4)
+		return sizeof(history_file_entry_v3);
+	return sizeof(history_file_entry);
+}
+
+
+void
+HistoryFile::_Unset()
+{
+	if (fAddress != NULL)
+		munmap(fAddress, fSize);
+	fAddress = NULL;
+	fSize = 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef HISTORYFILE_H
+#define HISTORYFILE_H
+
+#include <List.h>
+#include <Referenceable.h>
+#include <String.h>
+
+#include "ClipData.h"
+
+class ClipStore;
+
+
+// An entry of the history or the favorites, the latter don't use
+// origin and time.
+struct history_entry {
+						history_entry();
+						~history_entry();
+
+	ClipData*			clip;	// owns one reference
+	BString				title;
+	BString				origin;
+	int32				time;
+	int32				pasteCount;
+};
+
+
+// The binary snapshot of history and favorites. It is mapped into memory
+// as a whole. Every clip text is stored once, no matter how many entries
+// refer to it, and clips handed out by GetEntries() point right into
+// the mapping. Compressed clips are stored as they are kept in memory.
+class HistoryFile : public BReferenceable {
+public:
+						HistoryFile();
+	virtual				~HistoryFile();
+
+	status_t			SetTo(const char* path);
+
+	int32				Generation() const;
+	int32				QuitTime() const;
+	status_t			GetEntries(ClipStore* store, BList* history,
+							BList* favorites);
+
+	static status_t		Write(const char* path, BList* history,
+							BList* favorites, int32 generation,
+							int32 quitTime);
+	static void			EmptyEntries(BList* entries);
+
+private:
+	size_t				_ClipRecordSize() const;
+	size_t				_EntryRecordSize() const;
+	void				_Unset();
+
+	void*				fAddress;
+	size_t				fSize;
+};
+
+#endif // HISTORYFILE_H
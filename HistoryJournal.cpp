@@ -0,0 +1,725 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <Directory.h>
+#include <Entry.h>
+#include <FindDirectory.h>
+#include <List.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Constants.h"
+#include "HistoryJournal.h"
+
+static const uint32 kFrameMagic = 'Jrnl';
+
+enum {
+	kRecordHeader	= 'Jhdr',
+	kRecordAdd		= 'Jadd',
+	kRecordRemove	= 'Jrem',
+	kRecordMove		= 'Jmov',
+	kRecordClear	= 'Jclr'
+};
+
+struct journal_frame {
+	uint32			magic;
+	uint32			size;
+	uint32			checksum;
+};
+
+struct snapshot_job {
+	BList*			history;
+	BList*			favorites;
+	int32			generation;
+	int32			quitTime;
+	BPath			snapshotPath;
+	BPath			oldJournalPath;
+	BPath			pendingJournalPath;
+	BPath			legacyFavoritesPath;
+	int32*			compacting;
+	int32*			savedGeneration;
+	save_counters*	counters;
+	LatencyHistogram* latencies;
+};
+
+
+static uint32
+frame_checksum(const char* data, size_t size)
+{
+	// Adler-32
+	uint32 a = 1;
+	uint32 b = 0;
+	for (size_t i = 0; i < size; i++) {
+		a = (a + (uint8)data[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (b << 16) | a;
+}
+
+
+static status_t
+append_file(const char* sourcePath, const char* targetPath)
+{
+	BFile source(sourcePath, B_READ_ONLY);
+	BFile target(targetPath, B_WRITE_ONLY | B_OPEN_AT_END);
+	status_t status = source.InitCheck();
+	if (status == B_OK)
+		status = target.InitCheck();
+	if (status != B_OK)
+		return status;
+
+	char buffer[4096];
+	ssize_t bytes;
+	while ((bytes = source.Read(buffer, sizeof(buffer))) > 0) {
+		if (target.Write(buffer, bytes) != bytes)
+			return B_IO_ERROR;
+	}
+	if (bytes < 0)
+		return bytes;
+	return target.Sync();
+}
+
+
+HistoryJournal::HistoryJournal(const char* directory)
+	:
+	fGeneration(0),
+	fRecords(0),
+	fCompactThread(-1),
+	fCompacting(0),
+	fSavedGeneration(-1),
+	fSyncSem(-1),
+	fSyncThread(-1),
+	fJournalOpens(0)
+{
+	memset(&fCounters, 0, sizeof(fCounters));
+
+	BPath path;
+	if (directory != NULL)
+		path.SetTo(directory);
+	else if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) < B_OK
+		|| path.Append(kSettingsFolder) != B_OK)
+		return;
+	if (path.InitCheck() != B_OK)
+		return;
+	create_directory(path.Path(), 0777);
+
+	fSnapshotPath = path;
+	fSnapshotPath.Append(kHistoryFile);
+	fJournalPath = path;
+	fJournalPath.Append(kHistoryJournalFile);
+	fOldJournalPath = path;
+	fOldJournalPath.Append(kHistoryOldJournalFile);
+	fPendingJournalPath = path;
+	fPendingJournalPath.Append(kHistoryPendingJournalFile);
+	fLegacyFavoritesPath = path;
+	fLegacyFavoritesPath.Append(kFavoriteFile);
+
+	fSyncSem = create_sem(0, "journal sync");
+	if (fSyncSem < 0)
+		return;
+	fSyncThread = spawn_thread(_SyncJournal, "journal sync",
+		B_NORMAL_PRIORITY, this);
+	if (fSyncThread >= 0)
+		resume_thread(fSyncThread);
+	else {
+		delete_sem(fSyncSem);
+		fSyncSem = -1;
+	}
+}
+
+
+HistoryJournal::~HistoryJournal()
+{
+	// the sync thread syncs once more before it quits
+	if (fSyncThread >= 0) {
+		delete_sem(fSyncSem);
+		status_t result;
+		wait_for_thread(fSyncThread, &result);
+	}
+	if (fCompactThread >= 0) {
+		status_t result;
+		wait_for_thread(fCompactThread, &result);
+	}
+}
+
+
+status_t
+HistoryJournal::Load(ClipStore* store, BList* history, BList* favorites,
+	int32* quitTime)
+{
+	if (fSnapshotPath.InitCheck() != B_OK)
+		return B_ERROR;
+
+	*quitTime = 0;
+
+	HistoryFile* file = new HistoryFile;
+	status_t status = file->SetTo(fSnapshotPath.Path());
+	if (status == B_OK) {
+		fGeneration = file->Generation();
+		*quitTime = file->QuitTime();
+		if (file->GetEntries(store, history, favorites) != B_OK) {
+			HistoryFile::EmptyEntries(history);
+			HistoryFile::EmptyEntries(favorites);
+		}
+	} else {
+		if (status == B_BAD_DATA)
+			_LoadLegacySnapshot(store, history, quitTime);
+		_LoadLegacyFavorites(store, favorites);
+	}
+	file->ReleaseReference();
+
+	int32 snapshotGeneration = fGeneration;
+	_Replay(fOldJournalPath.Path(), snapshotGeneration, store, history,
+		quitTime);
+	_Replay(fPendingJournalPath.Path(), snapshotGeneration, store, history,
+		quitTime);
+	_Replay(fJournalPath.Path(), snapshotGeneration, store, history,
+		quitTime);
+	if (*quitTime == 0)
+		*quitTime = real_time_clock();
+
+	return _OpenJournal();
+}
+
+
+status_t
+HistoryJournal::Compact(BList* history, BList* favorites, int32 quitTime,
+	bool wait)
+{
+	if (fCompactThread >= 0) {
+		if (!wait && atomic_get(&fCompacting) != 0) {
+			HistoryFile::EmptyEntries(history);
+			HistoryFile::EmptyEntries(favorites);
+			delete history;
+			delete favorites;
+			return B_BUSY;
+		}
+		status_t result;
+		wait_for_thread(fCompactThread, &result);
+		fCompactThread = -1;
+	}
+
+	// Rotate the journal: everything recorded so far goes to the old
+	// journal, which is only removed once the snapshot is safely written.
+	// If a previous snapshot failed, its old journal is still there, the
+	// journal then waits as the pending one. Both are only renamed here,
+	// all copying is left to the snapshot writer.
+	fJournal.Unset();
+	BEntry journal(fJournalPath.Path());
+	if (journal.Exists()) {
+		BEntry oldJournal(fOldJournalPath.Path());
+		BEntry pendingJournal(fPendingJournalPath.Path());
+		if (!oldJournal.Exists())
+			journal.Rename(fOldJournalPath.Path(), false);
+		else if (!pendingJournal.Exists())
+			journal.Rename(fPendingJournalPath.Path(), false);
+		else {
+			// the snapshot writer couldn't add the pending journal to the
+			// old one either, this is the last resort
+			if (append_file(fJournalPath.Path(),
+					fPendingJournalPath.Path()) == B_OK)
+				journal.Remove();
+		}
+	}
+
+	fGeneration++;
+	status_t status = _OpenJournal();
+
+	snapshot_job* job = new snapshot_job;
+	job->history = history;
+	job->favorites = favorites;
+	job->generation = fGeneration;
+	job->quitTime = quitTime;
+	job->snapshotPath = fSnapshotPath;
+	job->oldJournalPath = fOldJournalPath;
+	job->pendingJournalPath = fPendingJournalPath;
+	job->legacyFavoritesPath = fLegacyFavoritesPath;
+	job->compacting = &fCompacting;
+	job->savedGeneration = &fSavedGeneration;
+	job->counters = &fCounters;
+	job->latencies = &fSaveLatency;
+
+	atomic_set(&fCompacting, 1);
+	fCompactThread = spawn_thread(_WriteSnapshot, "history compaction",
+		B_LOW_PRIORITY, job);
+	if (fCompactThread < 0) {
+		_WriteSnapshot(job);
+		return status;
+	}
+	resume_thread(fCompactThread);
+
+	if (wait) {
+		status_t result;
+		wait_for_thread(fCompactThread, &result);
+		fCompactThread = -1;
+	}
+	return status;
+}
+
+
+bool
+HistoryJournal::NeedsCompaction()
+{
+	return fRecords >= kJournalCompactRecords;
+}
+
+
+int32
+HistoryJournal::SavedGeneration()
+{
+	return atomic_get(&fSavedGeneration);
+}
+
+
+bool
+HistoryJournal::IsCompacting()
+{
+	return atomic_get(&fCompacting) != 0;
+}
+
+
+void
+HistoryJournal::GetCounters(save_counters* counters)
+{
+	counters->saves = atomic_get64(&fCounters.saves);
+	counters->failures = atomic_get64(&fCounters.failures);
+	counters->lastLatency = atomic_get64(&fCounters.lastLatency);
+	counters->maxLatency = atomic_get64(&fCounters.maxLatency);
+	counters->lastBytes = atomic_get64(&fCounters.lastBytes);
+	counters->totalBytes = atomic_get64(&fCounters.totalBytes);
+	counters->journalBytes = atomic_get64(&fCounters.journalBytes);
+	counters->journalSyncs = atomic_get64(&fCounters.journalSyncs);
+}
+
+
+void
+HistoryJournal::AddClip(ClipData* clip, const BString& origin, int32 time)
+{
+	BMessage record(kRecordAdd);
+	if (!clip->IsSpilled()) {
+		record.AddData("clip", B_RAW_TYPE, clip->StoredData(),
+			clip->StoredLength(), false);
+	}
+	if (clip->IsCompressed() || clip->IsSpilled()) {
+		record.AddBool("compressed", clip->IsCompressed());
+		record.AddBool("spilled", clip->IsSpilled());
+		record.AddInt64("length", clip->Length());
+		record.AddData("digest", B_RAW_TYPE, &clip->Digest(),
+			sizeof(clip_digest), false);
+	}
+	record.AddString("origin", origin);
+	record.AddInt32("time", time);
+	_Append(&record);
+}
+
+
+void
+HistoryJournal::RemoveClip(int32 index)
+{
+	RemoveClips(index, 1);
+}
+
+
+void
+HistoryJournal::RemoveClips(int32 index, int32 count)
+{
+	BMessage record(kRecordRemove);
+	record.AddInt32("index", index);
+	record.AddInt32("count", count);
+	_Append(&record);
+}
+
+
+void
+HistoryJournal::MoveClipToTop(int32 index, int32 time)
+{
+	BMessage record(kRecordMove);
+	record.AddInt32("index", index);
+	record.AddInt32("time", time);
+	_Append(&record);
+}
+
+
+void
+HistoryJournal::Clear()
+{
+	BMessage record(kRecordClear);
+	_Append(&record);
+}
+
+
+status_t
+HistoryJournal::_Append(BMessage* record)
+{
+	if (fJournal.InitCheck() != B_OK)
+		return B_NO_INIT;
+
+	record->AddInt32("when", real_time_clock());
+
+	// frame and record go to disk with a single write, so a crash can
+	// only ever leave a torn record at the very end of the journal
+	ssize_t size = record->FlattenedSize();
+	char* buffer = (char*)malloc(sizeof(journal_frame) + size);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+
+	status_t status = record->Flatten(buffer + sizeof(journal_frame), size);
+	if (status == B_OK) {
+		journal_frame* frame = (journal_frame*)buffer;
+		frame->magic = kFrameMagic;
+		frame->size = size;
+		frame->checksum = frame_checksum(buffer + sizeof(journal_frame), size);
+
+		ssize_t written = fJournal.Write(buffer, sizeof(journal_frame) + size);
+		if (written < (ssize_t)(sizeof(journal_frame) + size))
+			status = written < 0 ? written : B_IO_ERROR;
+		else {
+			// the sync thread takes it to disk, without it there's no
+			// waiting around it
+			if (fSyncThread < 0 || release_sem(fSyncSem) != B_OK)
+				status = fJournal.Sync();
+			fRecords++;
+			atomic_add64(&fCounters.journalBytes, written);
+		}
+	}
+	free(buffer);
+	return status;
+}
+
+
+status_t
+HistoryJournal::_OpenJournal()
+{
+	status_t status = fJournal.SetTo(fJournalPath.Path(),
+		B_WRITE_ONLY | B_CREATE_FILE | B_OPEN_AT_END);
+	if (status != B_OK)
+		return status;
+	atomic_add(&fJournalOpens, 1);
+
+	off_t size;
+	if (fJournal.GetSize(&size) == B_OK && size > 0)
+		return B_OK;
+
+	BMessage header(kRecordHeader);
+	header.AddInt32("generation", fGeneration);
+	status = _Append(&header);
+	fRecords = 0;
+	return status;
+}
+
+
+status_t
+HistoryJournal::_Replay(const char* path, int32 snapshotGeneration,
+	ClipStore* store, BList* entries, int32* lastTime)
+{
+	BFile file(path, B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if (status != B_OK)
+		return status;
+
+	off_t remaining;
+	status = file.GetSize(&remaining);
+	if (status != B_OK)
+		return status;
+
+	int32 generation = 0;
+	journal_frame frame;
+	while (file.Read(&frame, sizeof(frame)) == sizeof(frame)) {
+		// the size isn't covered by the checksum, it can't be trusted
+		// any further than the file goes
+		remaining -= sizeof(frame);
+		if (frame.magic != kFrameMagic || frame.size > remaining)
+			break;
+		remaining -= frame.size;
+
+		char* buffer = (char*)malloc(frame.size);
+		if (buffer == NULL)
+			return B_NO_MEMORY;
+
+		BMessage record;
+		if (file.Read(buffer, frame.size) != (ssize_t)frame.size
+			|| frame_checksum(buffer, frame.size) != frame.checksum
+			|| record.Unflatten(buffer) != B_OK) {
+			// torn record at the end of the journal
+			free(buffer);
+			break;
+		}
+		free(buffer);
+
+		int32 when;
+		if (record.FindInt32("when", &when) == B_OK && when > *lastTime)
+			*lastTime = when;
+
+		if (record.what == kRecordHeader) {
+			record.FindInt32("generation", &generation);
+			if (generation > fGeneration)
+				fGeneration = generation;
+			continue;
+		}
+
+		// records older than the snapshot are already part of it
+		if (generation < snapshotGeneration)
+			continue;
+
+		switch (record.what) {
+			case kRecordAdd:
+			{
+				history_entry* entry = new history_entry;
+				entry->clip = _InternRecord(store, &record);
+				if (entry->clip == NULL) {
+					delete entry;
+					break;
+				}
+				entry->clip->GetTitle(entry->title);
+				record.FindString("origin", &entry->origin);
+				record.FindInt32("time", &entry->time);
+				entries->AddItem(entry, 0);
+				break;
+			}
+			case kRecordRemove:
+			{
+				int32 index;
+				int32 count;
+				if (record.FindInt32("index", &index) != B_OK
+					|| record.FindInt32("count", &count) != B_OK)
+					break;
+				for (; count > 0 && index < entries->CountItems(); count--)
+					delete (history_entry*)entries->RemoveItem(index);
+				break;
+			}
+			case kRecordMove:
+			{
+				int32 index;
+				int32 time;
+				if (record.FindInt32("index", &index) != B_OK
+					|| record.FindInt32("time", &time) != B_OK)
+					break;
+				history_entry* entry
+					= (history_entry*)entries->ItemAt(index);
+				if (entry == NULL)
+					break;
+				// clips are only moved to the top when they're pasted
+				entry->time = time;
+				entry->pasteCount++;
+				entries->MoveItem(index, 0);
+				break;
+			}
+			case kRecordClear:
+				HistoryFile::EmptyEntries(entries);
+				break;
+		}
+	}
+	return B_OK;
+}
+
+
+ClipData*
+HistoryJournal::_InternRecord(ClipStore* store, BMessage* record)
+{
+	// large clips are journaled as they're kept in memory, spilled ones
+	// without their text
+	const clip_digest* digest;
+	ssize_t digestSize;
+	int64 textLength;
+	bool hasDigest = record->FindData("digest", B_RAW_TYPE,
+			(const void**)&digest, &digestSize) == B_OK
+		&& digestSize == sizeof(clip_digest)
+		&& record->FindInt64("length", &textLength) == B_OK;
+
+	if (record->GetBool("spilled", false)) {
+		if (!hasDigest)
+			return NULL;
+		return store->InternSpilled(textLength, *digest);
+	}
+
+	const char* data;
+	ssize_t length;
+	if (record->FindData("clip", B_RAW_TYPE, (const void**)&data, &length)
+			!= B_OK)
+		return NULL;
+
+	if (!record->GetBool("compressed", false))
+		return store->Intern(data, length);
+	if (!hasDigest)
+		return NULL;
+
+	ClipData* clip = new ClipData(data, length, textLength, true, *digest);
+	if (clip->InitCheck() != B_OK) {
+		clip->ReleaseReference();
+		return NULL;
+	}
+	return store->Intern(clip);
+}
+
+
+status_t
+HistoryJournal::_LoadLegacySnapshot(ClipStore* store, BList* history,
+	int32* quitTime)
+{
+	// the history used to be saved as one flattened BMessage
+	BMessage snapshot;
+	BFile file(fSnapshotPath.Path(), B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if (status == B_OK)
+		status = snapshot.Unflatten(&file);
+	if (status != B_OK)
+		return status;
+
+	if (snapshot.FindInt32("generation", &fGeneration) != B_OK)
+		fGeneration = 0;
+	snapshot.FindInt32("quittime", quitTime);
+
+	// the old snapshot lists the oldest clip first
+	BString clip;
+	BString origin;
+	int32 time;
+	int32 i = 0;
+	while ((snapshot.FindString("clip", i, &clip) == B_OK) &&
+			(snapshot.FindString("origin", i, &origin) == B_OK) &&
+			(snapshot.FindInt32("time", i, &time) == B_OK)) {
+		history_entry* entry = new history_entry;
+		entry->clip = store->Intern(clip.String(), clip.Length());
+		ClipData::MakeTitle(clip.String(), clip.Length(), entry->title);
+		entry->origin = origin;
+		entry->time = time;
+		if (entry->clip != NULL)
+			history->AddItem(entry, 0);
+		else
+			delete entry;
+		i++;
+	}
+	return B_OK;
+}
+
+
+status_t
+HistoryJournal::_LoadLegacyFavorites(ClipStore* store, BList* favorites)
+{
+	// the favorites used to have a file of their own
+	BMessage msg;
+	BFile file(fLegacyFavoritesPath.Path(), B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if (status == B_OK)
+		status = msg.Unflatten(&file);
+	if (status != B_OK)
+		return status;
+
+	BString clip;
+	BString title;
+	int32 i = 0;
+	while (msg.FindString("clip", i, &clip) == B_OK &&
+			msg.FindString("title", i, &title) == B_OK) {
+		history_entry* entry = new history_entry;
+		entry->clip = store->Intern(clip.String(), clip.Length());
+		entry->title = title;
+		if (entry->clip != NULL)
+			favorites->AddItem(entry);
+		else
+			delete entry;
+		i++;
+	}
+	return B_OK;
+}
+
+
+status_t
+HistoryJournal::_WriteSnapshot(void* data)
+{
+	snapshot_job* job = (snapshot_job*)data;
+	bigtime_t start = system_time();
+
+	BString tempPath(job->snapshotPath.Path());
+	tempPath.Append("~");
+
+	status_t status = HistoryFile::Write(tempPath.String(), job->history,
+		job->favorites, job->generation, job->quitTime);
+
+	off_t size = 0;
+	BEntry entry(tempPath.String());
+	if (status == B_OK)
+		status = entry.GetSize(&size);
+	if (status == B_OK)
+		status = entry.Rename(job->snapshotPath.Path(), true);
+
+	save_counters* counters = job->counters;
+	if (status == B_OK) {
+		bigtime_t latency = system_time() - start;
+		atomic_add64(&counters->saves, 1);
+		atomic_set64(&counters->lastLatency, latency);
+		job->latencies->Add(latency);
+		if (latency > atomic_get64(&counters->maxLatency))
+			atomic_set64(&counters->maxLatency, latency);
+		atomic_set64(&counters->lastBytes, size);
+		atomic_add64(&counters->totalBytes, size);
+	} else
+		atomic_add64(&counters->failures, 1);
+
+	// only now the old journals are covered by the snapshot, if it failed
+	// the pending one is added to the old one, the next compaction may
+	// need its place
+	BEntry pendingJournal(job->pendingJournalPath.Path());
+	if (status == B_OK) {
+		atomic_set(job->savedGeneration, job->generation);
+		BEntry oldJournal(job->oldJournalPath.Path());
+		oldJournal.Remove();
+		pendingJournal.Remove();
+		BEntry legacyFavorites(job->legacyFavoritesPath.Path());
+		legacyFavorites.Remove();
+	} else {
+		entry.Remove();
+		if (pendingJournal.Exists() && append_file(
+				job->pendingJournalPath.Path(),
+				job->oldJournalPath.Path()) == B_OK)
+			pendingJournal.Remove();
+	}
+
+	atomic_set(job->compacting, 0);
+	HistoryFile::EmptyEntries(job->history);
+	HistoryFile::EmptyEntries(job->favorites);
+	delete job->history;
+	delete job->favorites;
+	delete job;
+	return status;
+}
+
+
+/*static*/ status_t
+HistoryJournal::_SyncJournal(void* data)
+{
+	HistoryJournal* journal = (HistoryJournal*)data;
+
+	// The journal is synced through a file of its own. After the journal
+	// was rotated, that's still the old one, it's synced once more before
+	// the new one is opened.
+	BFile file;
+	int32 opens = 0;
+	status_t status;
+	do {
+		status = acquire_sem(journal->fSyncSem);
+
+		// all the records appended until now go with a single sync
+		int32 count;
+		if (get_sem_count(journal->fSyncSem, &count) == B_OK && count > 0)
+			acquire_sem_etc(journal->fSyncSem, count, 0, 0);
+
+		if (file.InitCheck() == B_OK)
+			file.Sync();
+		int32 opened = atomic_get(&journal->fJournalOpens);
+		if (opened != opens) {
+			opens = opened;
+			if (file.SetTo(journal->fJournalPath.Path(), B_READ_ONLY)
+					== B_OK)
+				file.Sync();
+		}
+		atomic_add64(&journal->fCounters.journalSyncs, 1);
+	} while (status == B_OK);
+
+	return B_OK;
+}
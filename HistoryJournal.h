@@ -0,0 +1,102 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef HISTORYJOURNAL_H
+#define HISTORYJOURNAL_H
+
+#include <File.h>
+#include <List.h>
+#include <Message.h>
+#include <OS.h>
+#include <Path.h>
+#include <String.h>
+
+#include "ClipStore.h"
+#include "HistoryFile.h"
+#include "LatencyHistogram.h"
+
+static const int32 kJournalCompactRecords = 256;
+
+// Counters of the snapshot writer. Latencies are in microseconds, from
+// the start of the write to the rename of the finished file.
+struct save_counters {
+	int64			saves;
+	int64			failures;
+	int64			lastLatency;
+	int64			maxLatency;
+	int64			lastBytes;
+	int64			totalBytes;
+	int64			journalBytes;
+	int64			journalSyncs;
+};
+
+
+// The history is kept on disk as a snapshot (Clipdinger_history) plus a
+// journal of small framed records, one per change of the history list.
+// Record indices are those of the history list, 0 being the newest clip.
+// The favorites are part of the snapshot, they aren't journaled.
+// Records are synced to disk by a thread of their own, all of those that
+// piled up since the last sync at once. A power loss may lose the last
+// few of them, replaying the journal then stops where it's torn.
+class HistoryJournal {
+public:
+	// in the settings folder, unless a directory is given
+					HistoryJournal(const char* directory = NULL);
+					~HistoryJournal();
+
+	status_t		Load(ClipStore* store, BList* history,
+						BList* favorites, int32* quitTime);
+	status_t		Compact(BList* history, BList* favorites,
+						int32 quitTime, bool wait = false);
+	bool			NeedsCompaction();
+	// of the last snapshot, and of the last one that was written
+	int32			Generation() const { return fGeneration; };
+	int32			SavedGeneration();
+	bool			IsCompacting();
+	void			GetCounters(save_counters* counters);
+	const LatencyHistogram& SaveLatency() const { return fSaveLatency; };
+
+	void			AddClip(ClipData* clip, const BString& origin,
+						int32 time);
+	void			RemoveClip(int32 index);
+	void			RemoveClips(int32 index, int32 count);
+	void			MoveClipToTop(int32 index, int32 time);
+	void			Clear();
+
+private:
+	status_t		_Append(BMessage* record);
+	status_t		_OpenJournal();
+	status_t		_LoadLegacySnapshot(ClipStore* store, BList* history,
+						int32* quitTime);
+	status_t		_LoadLegacyFavorites(ClipStore* store,
+						BList* favorites);
+	status_t		_Replay(const char* path, int32 snapshotGeneration,
+						ClipStore* store, BList* entries, int32* lastTime);
+	static ClipData* _InternRecord(ClipStore* store, BMessage* record);
+	static status_t	_WriteSnapshot(void* data);
+	static status_t	_SyncJournal(void* data);
+
+	BPath			fSnapshotPath;
+	BPath			fJournalPath;
+	BPath			fOldJournalPath;
+	BPath			fPendingJournalPath;
+	BPath			fLegacyFavoritesPath;
+	BFile			fJournal;
+	int32			fGeneration;
+	int32			fRecords;
+	thread_id		fCompactThread;
+	int32			fCompacting;
+	int32			fSavedGeneration;
+	sem_id			fSyncSem;
+	thread_id		fSyncThread;
+	int32			fJournalOpens;
+	save_counters	fCounters;
+	LatencyHistogram fSaveLatency;
+};
+
+#endif // HISTORYJOURNAL_H
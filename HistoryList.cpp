@@ -0,0 +1,174 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <new>
+
+#include "ClipItem.h"
+#include "HistoryList.h"
+
+
+HistoryList::HistoryList(int32 capacity)
+	:
+	fSlots(NULL),
+	fSlotCount(0),
+	fFirst(0),
+	fCount(0)
+{
+	SetCapacity(capacity);
+}
+
+
+HistoryList::~HistoryList()
+{
+	// like a BList, the list doesn't own the items
+	delete[] fSlots;
+}
+
+
+BListItem*
+HistoryList::ItemAt(int32 index) const
+{
+	return ClipAt(index);
+}
+
+
+ClipItem*
+HistoryList::ClipAt(int32 index) const
+{
+	if (index < 0 || index >= fCount)
+		return NULL;
+
+	return fSlots[_Slot(index)];
+}
+
+
+int32
+HistoryList::IndexOf(const ClipItem* item) const
+{
+	for (int32 front = 0, back = fCount - 1; front <= back; front++, back--) {
+		if (fSlots[_Slot(front)] == item)
+			return front;
+		if (fSlots[_Slot(back)] == item)
+			return back;
+	}
+	return -1;
+}
+
+
+void
+HistoryList::SetCapacity(int32 capacity)
+{
+	// the ring never shrinks, the history is cropped to the new limit
+	// right after anyway
+	if (capacity > fSlotCount)
+		_Grow(capacity);
+}
+
+
+bool
+HistoryList::AddFirst(ClipItem* item)
+{
+	if (fCount == fSlotCount && !_Grow(fCount + 1))
+		return false;
+
+	fFirst = (fFirst - 1) & (fSlotCount - 1);
+	fSlots[fFirst] = item;
+	fCount++;
+	return true;
+}
+
+
+bool
+HistoryList::AddLast(ClipItem* item)
+{
+	if (fCount == fSlotCount && !_Grow(fCount + 1))
+		return false;
+
+	fSlots[_Slot(fCount)] = item;
+	fCount++;
+	return true;
+}
+
+
+bool
+HistoryList::AddList(const BList* items)
+{
+	int32 count = items->CountItems();
+	if (fCount + count > fSlotCount && !_Grow(fCount + count))
+		return false;
+
+	for (int32 i = 0; i < count; i++)
+		fSlots[_Slot(fCount + i)] = (ClipItem*)items->ItemAt(i);
+	fCount += count;
+	return true;
+}
+
+
+bool
+HistoryList::RemoveItems(int32 index, int32 count)
+{
+	if (index < 0 || count <= 0 || index + count > fCount)
+		return false;
+
+	int32 after = fCount - index - count;
+	if (index < after) {
+		// the newer clips move back
+		for (int32 i = index - 1; i >= 0; i--)
+			fSlots[_Slot(i + count)] = fSlots[_Slot(i)];
+		fFirst = _Slot(count);
+	} else {
+		for (int32 i = index + count; i < fCount; i++)
+			fSlots[_Slot(i - count)] = fSlots[_Slot(i)];
+	}
+	fCount -= count;
+	return true;
+}
+
+
+bool
+HistoryList::MoveToFirst(int32 index)
+{
+	if (index < 0 || index >= fCount)
+		return false;
+
+	ClipItem* item = fSlots[_Slot(index)];
+	for (int32 i = index; i > 0; i--)
+		fSlots[_Slot(i)] = fSlots[_Slot(i - 1)];
+	fSlots[fFirst] = item;
+	return true;
+}
+
+
+void
+HistoryList::MakeEmpty()
+{
+	fFirst = 0;
+	fCount = 0;
+}
+
+
+bool
+HistoryList::_Grow(int32 count)
+{
+	int32 slotCount = 16;
+	while (slotCount < count)
+		slotCount *= 2;
+
+	ClipItem** slots = new(std::nothrow) ClipItem*[slotCount];
+	if (slots == NULL)
+		return false;
+
+	for (int32 i = 0; i < fCount; i++)
+		slots[i] = fSlots[_Slot(i)];
+
+	delete[] fSlots;
+	fSlots = slots;
+	fSlotCount = slotCount;
+	fFirst = 0;
+	return true;
+}
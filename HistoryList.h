@@ -0,0 +1,58 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef HISTORYLIST_H
+#define HISTORYLIST_H
+
+#include "ListModel.h"
+
+class ClipItem;
+
+
+// The clips of the history, newest first, in a ring of slots. Adding a
+// clip at either end, or dropping one from either end, doesn't move any
+// other. Moving a clip to the front, or removing one from the middle,
+// shifts the clips on the shorter side of it by a slot. They're only
+// pointers, and pasted clips are mostly recent ones, so there are few.
+// The ring has room for as many clips as the history is limited to, it
+// only grows when more are added, as while loading a larger history.
+// Index 0 is always the newest clip, so the indices are the same as the
+// rows of the list view showing the history.
+class HistoryList : public ListModel {
+public:
+						HistoryList(int32 capacity = 100);
+	virtual				~HistoryList();
+
+	virtual	int32		CountItems() const { return fCount; };
+	virtual	BListItem*	ItemAt(int32 index) const;
+	ClipItem*			ClipAt(int32 index) const;
+	// looks from both ends, the newest and the oldest clips are found first
+	int32				IndexOf(const ClipItem* item) const;
+
+	void				SetCapacity(int32 capacity);
+
+	bool				AddFirst(ClipItem* item);
+	bool				AddLast(ClipItem* item);
+	bool				AddList(const BList* items);
+	bool				RemoveItems(int32 index, int32 count);
+	bool				MoveToFirst(int32 index);
+	void				MakeEmpty();
+
+private:
+	// the number of slots is a power of two
+	int32				_Slot(int32 index) const
+							{ return (fFirst + index) & (fSlotCount - 1); };
+	bool				_Grow(int32 count);
+
+	ClipItem**			fSlots;
+	int32				fSlotCount;
+	int32				fFirst;
+	int32				fCount;
+};
+
+#endif // HISTORYLIST_H
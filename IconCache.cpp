@@ -0,0 +1,187 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <Autolock.h>
+#include <Directory.h>
+#include <Entry.h>
+#include <File.h>
+#include <FindDirectory.h>
+#include <Message.h>
+#include <Node.h>
+#include <NodeInfo.h>
+#include <Path.h>
+
+#include <string.h>
+
+#include "Constants.h"
+#include "IconCache.h"
+
+
+IconCache::IconCache()
+	:
+	fLock("icon cache"),
+	fDirty(false),
+	fHits(0),
+	fMisses(0)
+{
+	_Load();
+}
+
+
+IconCache::~IconCache()
+{
+	if (fDirty)
+		_Save();
+
+	for (IconMap::iterator it = fIcons.begin(); it != fIcons.end(); it++)
+		delete it->second.icon;
+	for (int32 i = 0; i < fStaleIcons.CountItems(); i++)
+		delete (BBitmap*)fStaleIcons.ItemAt(i);
+}
+
+
+BBitmap*
+IconCache::GetIcon(const char* path)
+{
+	BNode node;
+	time_t modified;
+	if (node.SetTo(path) != B_OK || node.GetModificationTime(&modified) != B_OK)
+		return NULL;
+
+	BAutolock _(fLock);
+
+	IconMap::iterator found = fIcons.find(path);
+	if (found != fIcons.end()) {
+		if (found->second.modified == modified) {
+			fHits++;
+			return found->second.icon;
+		}
+
+		// the app changed, items may still show the old icon though
+		if (found->second.icon != NULL)
+			fStaleIcons.AddItem(found->second.icon);
+		fIcons.erase(found);
+	}
+
+	fMisses++;
+	BBitmap* icon = _NewIcon();
+	BNodeInfo nodeInfo;
+	if (nodeInfo.SetTo(&node) != B_OK
+		|| nodeInfo.GetTrackerIcon(icon, B_MINI_ICON) != B_OK) {
+		delete icon;
+		icon = NULL;
+	}
+
+	icon_entry entry;
+	entry.modified = modified;
+	entry.icon = icon;
+	fIcons[path] = entry;
+	fDirty = true;
+	return icon;
+}
+
+
+void
+IconCache::GetCounters(int64* hits, int64* misses)
+{
+	BAutolock _(fLock);
+	*hits = fHits;
+	*misses = fMisses;
+}
+
+
+void
+IconCache::_Load()
+{
+	BPath path;
+	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) != B_OK
+		|| path.Append(kSettingsFolder) != B_OK
+		|| path.Append(kIconCacheFile) != B_OK)
+		return;
+
+	BFile file(path.Path(), B_READ_ONLY);
+	BMessage cache;
+	if (file.InitCheck() != B_OK || cache.Unflatten(&file) != B_OK)
+		return;
+
+	BMessage archive;
+	for (int32 i = 0; cache.FindMessage("icon", i, &archive) == B_OK; i++) {
+		BString appPath;
+		int64 modified;
+		if (archive.FindString("path", &appPath) != B_OK
+			|| archive.FindInt64("modified", &modified) != B_OK)
+			continue;
+
+		icon_entry entry;
+		entry.modified = modified;
+		entry.icon = NULL;
+
+		const void* bits;
+		ssize_t length;
+		if (archive.FindData("bits", B_RAW_TYPE, &bits, &length) == B_OK) {
+			entry.icon = _NewIcon();
+			if (length != entry.icon->BitsLength()) {
+				delete entry.icon;
+				continue;
+			}
+			memcpy(entry.icon->Bits(), bits, length);
+		}
+		fIcons[appPath] = entry;
+	}
+}
+
+
+void
+IconCache::_Save()
+{
+	BPath path;
+	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) != B_OK
+		|| path.Append(kSettingsFolder) != B_OK
+		|| create_directory(path.Path(), 0777) != B_OK
+		|| path.Append(kIconCacheFile) != B_OK)
+		return;
+
+	BMessage cache;
+	for (IconMap::iterator it = fIcons.begin(); it != fIcons.end(); it++) {
+		BMessage archive;
+		archive.AddString("path", it->first);
+		archive.AddInt64("modified", it->second.modified);
+		if (it->second.icon != NULL) {
+			archive.AddData("bits", B_RAW_TYPE, it->second.icon->Bits(),
+				it->second.icon->BitsLength());
+		}
+		cache.AddMessage("icon", &archive);
+	}
+
+	// like the settings, to a temporary file first, so a crash can't leave
+	// a half written cache behind
+	BString tempPath(path.Path());
+	tempPath.Append("~");
+
+	BFile file(tempPath.String(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	status_t status = file.InitCheck();
+	if (status == B_OK)
+		status = cache.Flatten(&file);
+	if (status == B_OK)
+		status = file.Sync();
+	file.Unset();
+
+	BEntry entry(tempPath.String());
+	if (status == B_OK)
+		status = entry.Rename(path.Path(), true);
+	if (status != B_OK)
+		entry.Remove();
+}
+
+
+BBitmap*
+IconCache::_NewIcon()
+{
+	return new BBitmap(BRect(0, 0, kIconSize - 1, kIconSize - 1), 0,
+		B_RGBA32);
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <Bitmap.h>
+#include <List.h>
+#include <Locker.h>
+#include <String.h>
+
+#include <map>
+
+
+// The mini icons of the apps clips come from. There are only a handful
+// of them, so all items share one bitmap per app. Entries are keyed by
+// the app's path and only valid as long as its modification time
+// doesn't change. The cache is kept on disk between runs.
+// Bitmaps belong to the cache and stay valid as long as it exists.
+class IconCache {
+public:
+						IconCache();
+						~IconCache();
+
+	BBitmap*			GetIcon(const char* path);
+	void				GetCounters(int64* hits, int64* misses);
+
+private:
+	struct icon_entry {
+		time_t			modified;
+		BBitmap*		icon;	// NULL if the app has none
+	};
+	typedef std::map<BString, icon_entry> IconMap;
+
+	void				_Load();
+	void				_Save();
+	BBitmap*			_NewIcon();
+
+	BLocker				fLock;
+	IconMap				fIcons;
+	BList				fStaleIcons;
+	bool				fDirty;
+	int64				fHits;
+	int64				fMisses;
+};
+
+#endif // ICONCACHE_H
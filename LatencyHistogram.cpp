@@ -0,0 +1,111 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "LatencyHistogram.h"
+
+
+LatencyHistogram::LatencyHistogram()
+{
+	memset(fShards, 0, sizeof(fShards));
+}
+
+
+void
+LatencyHistogram::Add(bigtime_t latency)
+{
+	if (latency < 0)
+		latency = 0;
+
+	int32 bucket = 0;
+	for (bigtime_t rest = latency; rest > 1 && bucket < kLatencyBuckets - 1;
+			rest >>= 1)
+		bucket++;
+
+	shard& counts = fShards[find_thread(NULL) % kLatencyShards];
+	atomic_add64(&counts.buckets[bucket], 1);
+	atomic_add64(&counts.count, 1);
+	atomic_add64(&counts.sum, latency);
+	// another thread sharing the shard may win, a max is a max anyway
+	if (latency > atomic_get64(&counts.max))
+		atomic_set64(&counts.max, latency);
+}
+
+
+int64
+LatencyHistogram::Count() const
+{
+	int64 count = 0;
+	for (int32 i = 0; i < kLatencyShards; i++)
+		count += atomic_get64(&fShards[i].count);
+	return count;
+}
+
+
+bigtime_t
+LatencyHistogram::Percentile(int32 percent) const
+{
+	shard total;
+	_Merge(total);
+	if (total.count == 0)
+		return 0;
+
+	int64 rank = (total.count * percent + 99) / 100;
+	int64 seen = 0;
+	for (int32 i = 0; i < kLatencyBuckets; i++) {
+		seen += total.buckets[i];
+		if (seen >= rank)
+			return std::min(((bigtime_t)2 << i) - 1, total.max);
+	}
+	return total.max;
+}
+
+
+bigtime_t
+LatencyHistogram::Max() const
+{
+	bigtime_t max = 0;
+	for (int32 i = 0; i < kLatencyShards; i++)
+		max = std::max(max, atomic_get64(&fShards[i].max));
+	return max;
+}
+
+
+status_t
+LatencyHistogram::AddTo(BMessage* message, const char* name) const
+{
+	shard total;
+	_Merge(total);
+
+	BMessage latencies;
+	latencies.AddInt64("count", total.count);
+	latencies.AddInt64("mean", total.count > 0 ? total.sum / total.count : 0);
+	latencies.AddInt64("p50", Percentile(50));
+	latencies.AddInt64("p90", Percentile(90));
+	latencies.AddInt64("p99", Percentile(99));
+	latencies.AddInt64("max", total.max);
+	return message->AddMessage(name, &latencies);
+}
+
+
+void
+LatencyHistogram::_Merge(shard& total) const
+{
+	memset(&total, 0, sizeof(total));
+	for (int32 i = 0; i < kLatencyShards; i++) {
+		shard& counts = fShards[i];
+		for (int32 j = 0; j < kLatencyBuckets; j++)
+			total.buckets[j] += atomic_get64(&counts.buckets[j]);
+		total.count += atomic_get64(&counts.count);
+		total.sum += atomic_get64(&counts.sum);
+		total.max = std::max(total.max, atomic_get64(&counts.max));
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <Message.h>
+#include <OS.h>
+
+static const int32 kLatencyBuckets = 32;
+static const int32 kLatencyShards = 8;
+
+
+// How long something took, in buckets of powers of two microseconds.
+// Adding a latency is a few uncontended atomic adds: every thread counts
+// in a shard of its own (well, most of the time), the shards are only
+// added up when the histogram is read. The percentiles are the upper
+// bounds of their buckets, so they're off by up to a factor of two.
+class LatencyHistogram {
+public:
+						LatencyHistogram();
+
+	void				Add(bigtime_t latency);
+	void				AddSince(bigtime_t start)
+							{ Add(system_time() - start); };
+
+	int64				Count() const;
+	bigtime_t			Percentile(int32 percent) const;
+	bigtime_t			Max() const;
+	// count, mean, p50, p90, p99 and max as a message of its own
+	status_t			AddTo(BMessage* message, const char* name) const;
+
+private:
+	struct shard {
+		int64			buckets[kLatencyBuckets];
+		int64			count;
+		int64			sum;
+		int64			max;
+	};
+
+	void				_Merge(shard& total) const;
+
+	mutable shard		fShards[kLatencyShards];
+};
+
+#endif // LATENCYHISTOGRAM_H
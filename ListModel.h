@@ -0,0 +1,43 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef LISTMODEL_H
+#define LISTMODEL_H
+
+#include <List.h>
+#include <ListItem.h>
+
+
+// The items a VirtualListView shows, in order. The view doesn't own them,
+// whoever changes the model tells the view about it afterwards.
+class ListModel {
+public:
+	virtual				~ListModel() {};
+
+	virtual	int32		CountItems() const = 0;
+	virtual	BListItem*	ItemAt(int32 index) const = 0;
+
+	bool				IsEmpty() const { return CountItems() == 0; };
+};
+
+
+// A plain BList of items as a model.
+class PlainListModel : public ListModel {
+public:
+						PlainListModel(const BList& items)
+							: fItems(items) {};
+
+	virtual	int32		CountItems() const { return fItems.CountItems(); };
+	virtual	BListItem*	ItemAt(int32 index) const
+							{ return (BListItem*)fItems.ItemAt(index); };
+
+private:
+	const BList&		fItems;
+};
+
+#endif // LISTMODEL_H
@@ -17,6 +17,8 @@
 #include <Roster.h>
 #include <Screen.h>
 
+#include <string.h>
+
 #include <algorithm>
 
 #include "App.h"
@@ -25,18 +27,92 @@
 #include "FavItem.h"
 #include "KeyCatcher.h"
 #include "MainWindow.h"
+#include "Scripting.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "MainWindow"
 
 
+static const char*
+filter_text(ClipData* clip, BString& buffer, size_t& length)
+{
+	// a clip that's packed or spilled isn't unpacked or read back from
+	// disk for every typed character, only its title is matched
+	if (clip->IsCompressed() || clip->IsSpilled()) {
+		clip->GetTitle(buffer);
+		length = buffer.Length();
+		return buffer.String();
+	}
+	return clip->GetText(buffer, length);
+}
+
+
+static const char*
+clip_item_text(BListItem* item, BString& buffer, size_t& length)
+{
+	return filter_text(((ClipItem*)item)->GetClipData(), buffer, length);
+}
+
+
+static const char*
+fav_item_text(BListItem* item, BString& buffer, size_t& length)
+{
+	return filter_text(((FavItem*)item)->GetClipData(), buffer, length);
+}
+
+
+static const BString&
+fav_item_title(BListItem* item)
+{
+	return ((FavItem*)item)->GetTitle();
+}
+
+
+static bigtime_t
+paste_delay(int32 milliseconds)
+{
+	// never shorter than the input device may keep the clipboard itself,
+	// or its answer would come too late
+	return std::max((bigtime_t)milliseconds * 1000, kMaxPasteGap);
+}
+
+
 MainWindow::MainWindow(BRect frame)
 	:
 	BWindow(frame, B_TRANSLATE_SYSTEM_NAME("Clipdinger"), B_TITLED_WINDOW,
 		B_NOT_CLOSABLE | B_NOT_ZOOMABLE | B_AUTO_UPDATE_SIZE_LIMITS,
 		B_ALL_WORKSPACES),
+		fStartupLatency(0),
+		fLoadStart(0),
+		fLoadLatency(0),
+		fSummonTime(0),
+		fPasteSeparator(0),
+		fPasteAwaited(-1),
+		fPasteDelay(kDefaultPasteDelay * 1000LL),
+		fPasteRunner(NULL),
+		fPasteTimer(0),
+		fHistoryList(&fClips),
+		fHistoryFilter(clip_item_text),
+		fFavoriteFilter(fav_item_text, fav_item_title),
+		fFilterPending(false),
+		fPendingEntries(NULL),
+		fPendingIndex(0),
+		fQuitTime(0),
+		fLoaderThread(-1),
+		fStopLoading(0),
+		fLoadNotified(0),
+		fLoadLock("history loader"),
+		fLoading(false),
+		fCompactRunner(NULL),
+		fAutosaveRunner(NULL),
+		fFavoritesDirty(false),
+		fFadeRunner(NULL),
+		fFadeDeadline(0),
+		fEditedFavorite(NULL),
 		fSettingsWindow(NULL)
 {
+	bigtime_t startTime = system_time();
+
 	KeyCatcher* catcher = new KeyCatcher("catcher");
 	AddChild(catcher);
 	catcher->Hide();
@@ -55,12 +131,28 @@ MainWindow::MainWindow(BRect frame)
 	}
 	ClipdingerSettings* settings = my_app->Settings();
 	int32 fade;
+	int32 coalesceQuiet = kDefaultCoalesceQuiet;
+	int32 coalesceLatency = kDefaultCoalesceLatency;
+	int32 eviction = kDefaultEviction;
+	int32 spillThreshold = kDefaultSpillThreshold;
+	int32 pasteDelay = kDefaultPasteDelay;
+	fMemoryLimit = kDefaultMemoryLimit;
 	if (settings->Lock()) {
 		fAutoPaste = settings->GetAutoPaste();
+		pasteDelay = settings->GetPasteDelay();
 		fLimit = settings->GetLimit();
+		fMemoryLimit = settings->GetMemoryLimit();
+		eviction = settings->GetEviction();
+		spillThreshold = settings->GetSpillThreshold();
 		fade = settings->GetFade();
+		coalesceQuiet = settings->GetCoalesceQuiet();
+		coalesceLatency = settings->GetCoalesceLatency();
 		settings->Unlock();
 	}
+	fMemoryLimit *= 1024 * 1024;
+	fPasteDelay = paste_delay(pasteDelay);
+	fHistoryList.SetCapacity(fLimit);
+	fHistoryList.SetEvictionPolicy(EvictionPolicy::Create(eviction));
 
 	if (!fade) {
 		fPauseCheckBox->Hide();		// Hide() twice, because the window
@@ -68,28 +160,64 @@ MainWindow::MainWindow(BRect frame)
 		InvalidateLayout();
 	}
 	fLaunchTime = real_time_clock();
+	_LoadFadeSettings();
+
+	BPath spillPath;
+	if (find_directory(B_USER_SETTINGS_DIRECTORY, &spillPath) == B_OK
+		&& spillPath.Append(kSettingsFolder) == B_OK
+		&& spillPath.Append(kSpillFolder) == B_OK)
+		fClips.SetSpillDirectory(spillPath.Path());
+	fClips.SetSpillThreshold((size_t)spillThreshold * 1024 * 1024);
 
 	_LoadHistory();
-	_LoadFavorites();
+	fClips.PurgeSpillDirectory();
 
 	if (!fHistory->IsEmpty())
 		fHistory->Select(0);
 	if (!fFavorites->IsEmpty())
 		fFavorites->Select(0);
 
-	if (GetClipboard() == "") {
-		if (!fHistory->IsEmpty()) {
-			ClipItem* item = dynamic_cast<ClipItem *> (fHistory->ItemAt(0));
-			BString text(item->GetClip());
-			PutClipboard(text);
+	if (!HasClipboardText()) {
+		if (!fHistoryList.IsEmpty()) {
+			ClipItem* item = (ClipItem*)fHistoryList.ItemAt(0);
+			PutClipboard(item->GetClipData());
 		}
 	}
+	fIngest = new ClipIngest(&fClips, BMessenger(this));
+	fIngest->SetCoalescing(coalesceQuiet * 1000LL, coalesceLatency * 1000LL);
+	fIngest->Run();
+	fPaste = new PasteClient(BMessenger(this));
 	be_clipboard->StartWatching(this);
+	fStartupLatency = system_time() - startTime;
+
+	// only now the rest of the history is loaded
+	if (fPendingEntries != NULL) {
+		fLoading = true;
+		fLoaderThread = spawn_thread(_LoadRemainder, "history loader",
+			B_LOW_PRIORITY, this);
+		if (fLoaderThread < 0 || resume_thread(fLoaderThread) != B_OK) {
+			fLoaderThread = -1;
+			_LoadRemainder(this);
+			_FinishLoading();
+		}
+	}
+
+	BMessage compact(COMPACT_HISTORY);
+	fCompactRunner = new BMessageRunner(this, &compact, kCompactInterval);
 }
 
 
 MainWindow::~MainWindow()
 {
+	// whatever it still sends won't arrive anymore
+	if (fIngest->Lock())
+		fIngest->Quit();
+	_StopPasteSequence();
+	delete fPaste;
+	_FinishLoading(true);
+	delete fCompactRunner;
+	delete fAutosaveRunner;
+	delete fFadeRunner;
 }
 
 
@@ -117,8 +245,8 @@ MainWindow::_SetSplitview()
 bool
 MainWindow::QuitRequested()
 {
-	_SaveHistory();
-	_SaveFavorites();
+	_FinishLoading();
+	_SaveHistory(true);
 
 	ClipdingerSettings* settings = my_app->Settings();
 	if (settings->Lock()) {
@@ -143,6 +271,17 @@ MainWindow::QuitRequested()
 }
 
 
+void
+MainWindow::WindowActivated(bool active)
+{
+	// for the latency from bringing up the window to the paste
+	if (active)
+		fSummonTime = system_time();
+
+	BWindow::WindowActivated(active);
+}
+
+
 void
 MainWindow::_BuildLayout()
 {
@@ -202,6 +341,11 @@ MainWindow::_BuildLayout()
 	favoriteHeader->SetFont(&font);
 	favoriteHeader->SetAlignment(B_ALIGN_CENTER);
 
+	// The filter
+	fFilterControl = new BTextControl("filter", B_TRANSLATE("Filter:"), "",
+		NULL);
+	fFilterControl->SetModificationMessage(new BMessage(FILTER));
+
 	// The pause checkbox
 	fPauseCheckBox = new BCheckBox("pause", B_TRANSLATE("Pause fading"),
 		new BMessage(PAUSE));
@@ -238,8 +382,14 @@ MainWindow::_BuildLayout()
 
 	BLayoutBuilder::Group<>(this, B_VERTICAL, 0)
 		.Add(menuBar)
+		.AddGroup(B_HORIZONTAL)
+			.SetInsets(spacing, spacing, spacing, 0)
+			.Add(fFilterControl)
+		.End()
 		.Add(fMainSplitView);
 
+	fHistory->SetModel(&fHistoryList);
+	fHistory->SetMultipleSelection(true);
 	fHistory->MakeFocus(true);
 	fHistory->SetInvocationMessage(new BMessage(INSERT_HISTORY));
 	fHistory->SetViewColor(B_TRANSPARENT_COLOR);
@@ -248,146 +398,412 @@ MainWindow::_BuildLayout()
 }
 
 
+status_t
+MainWindow::_SaveHistory(bool wait)
+{
+	// a snapshot needs the complete history
+	if (fLoading)
+		return B_BUSY;
+
+	fClips.DeleteSpillFiles(fJournal.SavedGeneration());
+
+	BList* history = new BList(fHistoryList.CountItems());
+	BList* favorites = new BList(fFavoriteList.CountItems());
+
+	for (int i = 0; i < fHistoryList.CountItems(); i++)
+	{
+		ClipItem *sItem = (ClipItem*)fHistoryList.ItemAt(i);
+
+		history_entry* entry = new history_entry;
+		entry->clip = sItem->GetClipData();
+		entry->clip->AcquireReference();
+		entry->title = sItem->GetClipTitle();
+		entry->origin = sItem->GetOrigin();
+		entry->time = sItem->GetTimeAdded();
+		entry->pasteCount = sItem->GetPasteCount();
+		history->AddItem(entry);
+	}
+
+	for (int i = 0; i < fFavoriteList.CountItems(); i++)
+	{
+		FavItem *sItem = (FavItem*)fFavoriteList.ItemAt(i);
+
+		history_entry* entry = new history_entry;
+		entry->clip = sItem->GetClipData();
+		entry->clip->AcquireReference();
+		entry->title = sItem->GetTitle();
+		favorites->AddItem(entry);
+	}
+
+	// the journal takes ownership of the entries and writes them
+	// in the background, unless we're asked to wait for it
+	status_t status = fJournal.Compact(history, favorites, real_time_clock(),
+		wait);
+
+	// the spill files of clips removed until now aren't needed by this
+	// snapshot anymore
+	if (status == B_OK)
+		fClips.RetireSpillFiles(fJournal.Generation());
+	if (wait)
+		fClips.DeleteSpillFiles(fJournal.SavedGeneration());
+	return status;
+}
+
+
+void
+MainWindow::_ScheduleAutosave()
+{
+	// wait for things to calm down, every change restarts the timer
+	delete fAutosaveRunner;
+	BMessage autosave(AUTOSAVE);
+	fAutosaveRunner = new BMessageRunner(this, &autosave, kAutosaveDelay, 1);
+}
+
+
 void
-MainWindow::_SaveHistory()
+MainWindow::_Autosave()
 {
-	BPath path;
-	BMessage msg;
+	delete fAutosaveRunner;
+	fAutosaveRunner = NULL;
+
+	// the history itself is journaled as it changes, only the favorites
+	// need a new snapshot
+	bool busy = false;
+	if (fFavoritesDirty) {
+		status_t status = B_BUSY;
+		if (!fJournal.IsCompacting())
+			status = _SaveHistory();
+		if (status == B_OK)
+			fFavoritesDirty = false;
+		else if (status == B_BUSY)
+			busy = true;
+	}
 
-	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) < B_OK)
+	ClipdingerSettings* settings = my_app->Settings();
+	if (settings->Lock()) {
+		if (settings->Save() == B_BUSY)
+			busy = true;
+		settings->Unlock();
+	}
+
+	// a previous save is still being written, try again later
+	if (busy)
+		_ScheduleAutosave();
+}
+
+
+void
+MainWindow::_LoadHistory()
+{
+	fLoadStart = system_time();
+	BList* history = new BList;
+	BList favorites;
+
+	if (fJournal.Load(&fClips, history, &favorites, &fQuitTime) != B_OK) {
+		HistoryFile::EmptyEntries(history);
+		HistoryFile::EmptyEntries(&favorites);
+		delete history;
 		return;
-	status_t ret = path.Append(kSettingsFolder);
-
-	if (ret == B_OK)
-		ret = create_directory(path.Path(), 0777);
-
-	if (ret == B_OK)
-		path.Append(kHistoryFile);
-
-	if (ret == B_OK) {
-		BFile file(path.Path(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
-		ret = file.InitCheck();
-
-		if (ret == B_OK) {
-			for (int i = fHistory->CountItems() - 1; i >= 0 ; i--)
-			{
-				ClipItem *sItem = dynamic_cast<ClipItem *>
-					(fHistory->ItemAt(i));
-
-				BString clip(sItem->GetClip());
-				BString path(sItem->GetOrigin());
-				int32 time(sItem->GetTimeAdded());
-				msg.AddString("clip", clip.String());
-				msg.AddString("origin", path.String());
-				msg.AddInt32("time", time);
-			}
-			msg.AddInt32("quittime", real_time_clock());
-			msg.Flatten(&file);
+	}
+
+	BList items;
+	for (int32 i = 0; i < favorites.CountItems(); i++) {
+		history_entry* entry = (history_entry*)favorites.ItemAt(i);
+		items.AddItem(new FavItem(entry->clip, entry->title, i));
+		fHistoryList.AddFavorite(entry->clip);
+	}
+	fFavoriteList.AddList(&items);
+	fFavorites->AddList(&items);
+	HistoryFile::EmptyEntries(&favorites);
+
+	// Only what fits into the window is added right away, the rest is
+	// left to the loader thread once we're watching the clipboard.
+	font_height fheight;
+	be_plain_font->GetHeight(&fheight);
+	int32 visible = (int32)(Frame().Height() / (fheight.ascent
+		+ fheight.descent + fheight.leading + 7)) + 1;
+
+	fPendingEntries = history;
+	fPendingIndex = 0;
+	for (; fPendingIndex < history->CountItems()
+			&& fPendingIndex < visible; fPendingIndex++) {
+		history_entry* entry = (history_entry*)history->ItemAt(fPendingIndex);
+		ClipItem* item = new ClipItem(entry->clip, entry->title,
+			entry->origin, entry->time + (fLaunchTime - fQuitTime));
+		item->SetPasteCount(entry->pasteCount);
+		fLoadedItems.AddItem(item);
+	}
+	_AppendLoadedItems();
+
+	if (fPendingIndex == history->CountItems()) {
+		HistoryFile::EmptyEntries(history);
+		delete history;
+		fPendingEntries = NULL;
+		fLoadLatency = system_time() - fLoadStart;
+		if (fJournal.NeedsCompaction())
+			_SaveHistory();
+	}
+}
+
+
+/*static*/ status_t
+MainWindow::_LoadRemainder(void* data)
+{
+	MainWindow* window = (MainWindow*)data;
+	BList* entries = window->fPendingEntries;
+
+	// clip texts stay in the mapped history file until they're needed
+	BList batch;
+	for (int32 i = window->fPendingIndex; i < entries->CountItems(); i++) {
+		if (atomic_get(&window->fStopLoading) != 0)
+			break;
+
+		history_entry* entry = (history_entry*)entries->ItemAt(i);
+		ClipItem* item = new ClipItem(entry->clip, entry->title,
+			entry->origin, entry->time
+				+ (window->fLaunchTime - window->fQuitTime));
+		item->SetPasteCount(entry->pasteCount);
+		batch.AddItem(item);
+
+		if (batch.CountItems() == kLoadBatchSize
+			|| i == entries->CountItems() - 1) {
+			window->fLoadLock.Lock();
+			window->fLoadedItems.AddList(&batch);
+			window->fLoadLock.Unlock();
+			batch.MakeEmpty();
+
+			// only ever one notification on its way
+			if (atomic_or(&window->fLoadNotified, 1) == 0)
+				window->PostMessage(HISTORY_LOADED);
 		}
 	}
+	for (int32 i = 0; i < batch.CountItems(); i++)
+		delete (ClipItem*)batch.ItemAt(i);
+
+	HistoryFile::EmptyEntries(entries);
+
+	BMessage done(HISTORY_LOADED);
+	done.AddBool("done", true);
+	window->PostMessage(&done);
+	return B_OK;
 }
 
 
 void
-MainWindow::_LoadHistory()
+MainWindow::_AppendLoadedItems()
 {
-	BPath path;
-	BMessage msg;
-
-	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) == B_OK) {
-		status_t ret = path.Append(kSettingsFolder);
-		if (ret == B_OK) {
-			path.Append(kHistoryFile);
-			BFile file(path.Path(), B_READ_ONLY);
-
-			if (file.InitCheck() != B_OK || (msg.Unflatten(&file) != B_OK))
-				return;
-			else {
-				BString clip;
-				BString path;
-				int32 time;
-				int32 quittime;
-				if (msg.FindInt32("quittime", &quittime) != B_OK) {
-					int32 quittime(real_time_clock());
-				}
-				int32 i = 0;
-				while ((msg.FindString("clip", i, &clip) == B_OK) &&
-						(msg.FindString("origin", i, &path) == B_OK) &&
-						(msg.FindInt32("time", i, &time) == B_OK)) {
-					time = time + (fLaunchTime - quittime);
-					AddClip(clip, path, time);
-					i++;
-				}
-				fHistory->AdjustColors();
-			}
+	atomic_set(&fLoadNotified, 0);
+
+	fLoadLock.Lock();
+	BList loaded(fLoadedItems);
+	fLoadedItems.MakeEmpty();
+	fLoadLock.Unlock();
+
+	int32 first = fHistoryList.CountItems();
+	int32 now = real_time_clock();
+	for (int32 i = 0; i < loaded.CountItems(); i++) {
+		ClipItem* item = (ClipItem*)loaded.ItemAt(i);
+		if (fHistoryList.Contains(item->GetClipData())
+			|| !fHistoryList.AddLast(item)) {
+			// older histories may contain the same clip more than once,
+			// or it was copied again while we were still loading
+			fJournal.RemoveClip(fHistoryList.CountItems());
+			delete item;
+			continue;
 		}
+		fFades.Add(item, now);
 	}
+	_ScheduleFade();
+
+	// the list view hears of them all in one go, not item by item
+	// while filtering, they're only looked at once everything is loaded
+	if (!_IsFiltering())
+		fHistory->ItemsAdded(first, fHistoryList.CountItems() - first);
+	else if (!fLoading)
+		_InvalidateFilter();
+
+	int32 count = fHistoryList.CountItems();
+	if (count > fLimit)
+		_RemoveClips(fLimit, count - fLimit);
+	_EnforceMemoryLimit();
 }
 
 
 void
-MainWindow::_SaveFavorites()
+MainWindow::_FinishLoading(bool discard)
 {
-	BPath path;
-	BMessage msg;
+	if (fLoaderThread >= 0) {
+		if (discard)
+			atomic_set(&fStopLoading, 1);
+		status_t result;
+		wait_for_thread(fLoaderThread, &result);
+		fLoaderThread = -1;
+	}
+
+	if (discard) {
+		fLoadLock.Lock();
+		for (int32 i = 0; i < fLoadedItems.CountItems(); i++)
+			delete (ClipItem*)fLoadedItems.ItemAt(i);
+		fLoadedItems.MakeEmpty();
+		fLoadLock.Unlock();
+	} else {
+		_AppendLoadedItems();
+		if (fLoading)
+			fLoadLatency = system_time() - fLoadStart;
+	}
+
+	delete fPendingEntries;
+	fPendingEntries = NULL;
+	fLoading = false;
+	_InvalidateFilter();
+}
+
 
-	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) < B_OK)
+void
+MainWindow::_RemoveClips(int32 index, int32 count)
+{
+	fJournal.RemoveClips(index, count);
+	bool filtering = _IsFiltering();
+	for (int32 i = index + count - 1; i >= index; i--) {
+		ClipItem* item = (ClipItem*)fHistoryList.ItemAt(i);
+		if (filtering)
+			fHistory->RemoveItem(item);
+		fFades.Remove(item);
+	}
+	fHistoryList.RemoveItems(index, count);
+	if (filtering)
+		_InvalidateFilter();
+	else
+		fHistory->ItemsRemoved(index, count);
+}
+
+
+void
+MainWindow::_EnforceMemoryLimit()
+{
+	if (fMemoryLimit <= 0)
 		return;
-	status_t ret = path.Append(kSettingsFolder);
 
-	if (ret == B_OK)
-		ret = create_directory(path.Path(), 0777);
+	// the newest clip and clips that are favorites as well always stay
+	while (fHistoryList.Bytes() > fMemoryLimit) {
+		int32 victim = fHistoryList.NextEviction();
+		if (victim < 0)
+			break;
+		_RemoveClips(victim, 1);
+	}
+}
 
-	if (ret == B_OK)
-		path.Append(kFavoriteFile);
 
-	if (ret == B_OK) {
-		BFile file(path.Path(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
-		ret = file.InitCheck();
+bool
+MainWindow::_IsFiltering()
+{
+	return fFilterControl->Text()[0] != '\0';
+}
 
-		if (ret == B_OK) {
-			for (int i = 0; i < fFavorites->CountItems(); i++)
-			{
-				FavItem *sItem = dynamic_cast<FavItem *>
-					(fFavorites->ItemAt(i));
 
-				BString clip(sItem->GetClip());
-				BString title(sItem->GetTitle());
-				msg.AddString("clip", clip.String());
-				msg.AddString("title", title.String());
-			}
-			msg.Flatten(&file);
-		}
+void
+MainWindow::_ApplyFilter()
+{
+	const char* query = fFilterControl->Text();
+	if (!fFilterPending && fFilterText == query)
+		return;
+
+	fFilterPending = false;
+	fFilterText = query;
+
+	// the views only ever hold the items, they don't own them, the
+	// history view shows the history itself unless it's filtered
+	fHistory->MakeEmpty();
+	fFavorites->MakeEmpty();
+	if (query[0] == '\0') {
+		fHistoryFilter.Reset();
+		fFavoriteFilter.Reset();
+		fHistory->SetModel(&fHistoryList);
+		fFavorites->AddList(&fFavoriteList);
+	} else {
+		BList matches(kMaxFilterResults);
+		fHistoryFilter.Filter(query, fHistoryList, matches, kMaxFilterResults);
+		fHistory->SetModel(NULL);
+		fHistory->AddList(&matches);
+		fFavoriteFilter.Filter(query, PlainListModel(fFavoriteList), matches,
+			kMaxFilterResults);
+		fFavorites->AddList(&matches);
+	}
+
+	fButtonUp->SetEnabled(query[0] == '\0');
+	fButtonDown->SetEnabled(query[0] == '\0');
+
+	// the best matches come first
+	if (!fHistory->IsEmpty()) {
+		fHistory->Select(0);
+		fHistory->ScrollToSelection();
+	}
+	if (!fFavorites->IsEmpty()) {
+		fFavorites->Select(0);
+		fFavorites->ScrollToSelection();
 	}
 }
 
 
+// Called after the history or favorites changed while filtering: the
+// earlier matches may be gone, and new clips may match as well.
 void
-MainWindow::_LoadFavorites()
+MainWindow::_InvalidateFilter()
 {
-	BPath path;
-	BMessage msg;
+	if (!_IsFiltering())
+		return;
 
-	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) == B_OK) {
-		status_t ret = path.Append(kSettingsFolder);
-		if (ret == B_OK) {
-			path.Append(kFavoriteFile);
-			BFile file(path.Path(), B_READ_ONLY);
+	fHistoryFilter.Reset();
+	fFavoriteFilter.Reset();
 
-			if (file.InitCheck() != B_OK || (msg.Unflatten(&file) != B_OK))
-				return;
-			else {
-				BString clip;
-				BString title;
-				int32 i = 0;
-				while (msg.FindString("clip", i, &clip) == B_OK &&
-						msg.FindString("title", i, &title) == B_OK) {
-					fFavorites->AddItem(new FavItem(clip, title, i), i);
-					i++;
-				}
-			}
-		}
+	// however many changes there are, filter only once
+	if (!fFilterPending) {
+		fFilterPending = true;
+		PostMessage(FILTER);
+	}
+}
+
+
+void
+MainWindow::_ClearFilter()
+{
+	if (!_IsFiltering())
+		return;
+
+	fFilterControl->SetText("");
+	_ApplyFilter();
+}
+
+
+void
+MainWindow::_TypeToFilter(BMessage* message)
+{
+	const char* bytes;
+	if (message->FindString("bytes", &bytes) != B_OK)
+		return;
+
+	// the space bar invokes the selected item until there's a filter
+	if (bytes[0] == B_SPACE && !_IsFiltering()) {
+		VirtualListView* view = dynamic_cast<VirtualListView*>(CurrentFocus());
+		if (view != NULL)
+			view->Invoke();
+		return;
 	}
+
+	BString text(fFilterControl->Text());
+	if (bytes[0] == B_BACKSPACE) {
+		// remove the whole last character, not just its last byte
+		int32 length = text.Length() - 1;
+		while (length > 0 && (text.ByteAt(length) & 0xc0) == 0x80)
+			length--;
+		if (length < 0)
+			return;
+		text.Truncate(length);
+	} else
+		text << bytes;
+
+	fFilterControl->SetText(text);
+	_ApplyFilter();
 }
 
 
@@ -398,27 +814,72 @@ MainWindow::MessageReceived(BMessage* message)
 	{
 		case B_CLIPBOARD_CHANGED:
 		{
-			BString clip(GetClipboard());
-			if (clip.Length() == 0)
+			// all the work is done by the ingest looper
+			fIngest->PostMessage(B_CLIPBOARD_CHANGED);
+			break;
+		}
+		case CLIP_INGESTED:
+		{
+			ClipItem* item;
+			if (message->FindPointer("item", (void**)&item) != B_OK)
 				break;
 			fHistory->DeselectAll();
 
-			app_info info;
-			BPath path;
-			be_roster->GetActiveAppInfo(&info);
-			BEntry entry(&info.ref);
-			entry.GetPath(&path);
-
-			MakeItemUnique(clip);
-			int32 time(real_time_clock());
-			AddClip(clip, path.Path(), time);
+			MakeItemUnique(item->GetClipData());
+			AddClip(item);
+			_EnforceMemoryLimit();
+			fIngestLatency.AddSince(message->GetInt64("start", system_time()));
 
 			fHistory->Select(0);
 			break;
 		}
+		case PASTE_DONE:
+		{
+			bigtime_t injected = message->GetInt64("injected", 0);
+			fPasteLatency.Add(injected - message->GetInt64("requested",
+				injected));
+			// only the first paste after the window was brought up
+			if (fSummonTime > 0) {
+				fSummonLatency.Add(injected - fSummonTime);
+				fSummonTime = 0;
+			}
+
+			// the device only answers once the target had the gap to take
+			// the clip, the next one can replace it right away
+			if (!fPasteQueue.IsEmpty()
+				&& message->GetInt32("sequence", -1) == fPasteAwaited)
+				_PasteNext();
+			break;
+		}
+		case PASTE_SEQUENCE:
+		{
+			_PasteSelection(message->GetInt32("separator", 0));
+			break;
+		}
+		case PASTE_TIMEOUT:
+		{
+			// the input device didn't answer, it may be an older one, the
+			// clipboard was kept for the paste delay instead
+			if (message->GetInt32("timer", -1) == fPasteTimer)
+				_PasteNext();
+			break;
+		}
 		case ESCAPE:
 		{
-			Minimize(true);
+			if (_IsFiltering())
+				_ClearFilter();
+			else
+				Minimize(true);
+			break;
+		}
+		case FILTER:
+		{
+			_ApplyFilter();
+			break;
+		}
+		case FILTER_TYPED:
+		{
+			_TypeToFilter(message);
 			break;
 		}
 		case DELETE:
@@ -427,11 +888,17 @@ MainWindow::MessageReceived(BMessage* message)
 			if ((fHistory->IsEmpty()) || (index < 0))
 				break;
 
-			fHistory->RemoveItem(index);
+			_RemoveClips(fHistoryList.IndexOf(
+				(ClipItem*)fHistory->ItemAt(index)), 1);
 			int32 count = fHistory->CountItems();
 			fHistory->Select((index > count - 1) ? count - 1 : index);
 			break;
 		}
+		case ADJUSTCOLORS:
+		{
+			_AdvanceFade();
+			break;
+		}
 		case PAUSE:
 		{
 			int32 pause = fPauseCheckBox->Value();
@@ -440,11 +907,16 @@ MainWindow::MessageReceived(BMessage* message)
 				settings->SetFadePause(pause);
 				settings->Unlock();
 			}
+			// catch up with what was held back
+			if (!pause)
+				_AdvanceFade();
 			break;
 		}
 		case FAV_ADD:
 		{
 			AddFav();
+			fFavoritesDirty = true;
+			_ScheduleAutosave();
 			break;
 		}
 		case FAV_DELETE:
@@ -453,8 +925,8 @@ MainWindow::MessageReceived(BMessage* message)
 			if ((fFavorites->IsEmpty()) || (index < 0))
 				break;
 
-			fFavorites->RemoveItem(index);
-			RenumberFavorites(index);
+			_RemoveFavorites(fFavoriteList.IndexOf(fFavorites->ItemAt(index)),
+				1);
 			int32 count = fFavorites->CountItems();
 			fFavorites->Select((index > count - 1) ? count - 1 : index);
 			break;
@@ -463,32 +935,54 @@ MainWindow::MessageReceived(BMessage* message)
 		{
 			FavItem *fav = dynamic_cast<FavItem *>
 				(fFavorites->ItemAt(fFavorites->CurrentSelection()));
-			fEditWindow = new EditWindow(Frame(), fav);
-			fEditWindow->Show();
+			if (fav == NULL)
+				break;
+			fEditedFavorite = fav;
+			EditWindow* editWindow = new EditWindow(Frame(), fav->GetTitle());
+			fEditWindow = BMessenger(editWindow);
+			editWindow->Show();
 			break;
 		}
 		case FAV_DOWN:
 		{
+			// the order can't be seen while filtering
 			int32 index = fFavorites->CurrentSelection();
 			int32 last = fFavorites->CountItems();
-			if ((index == last - 1) || (index < 0))
+			if ((index == last - 1) || (index < 0) || _IsFiltering())
 				break;
+			fFavoriteList.SwapItems(index, index + 1);
 			fFavorites->SwapItems(index, index + 1);
 			RenumberFavorites(index);
+			fFavoritesDirty = true;
+			_ScheduleAutosave();
 			break;
 		}
 		case FAV_UP:
 		{
 			int32 index = fFavorites->CurrentSelection();
-			if (index <= 0)
+			if ((index <= 0) || _IsFiltering())
 				break;
+			fFavoriteList.SwapItems(index, index - 1);
 			fFavorites->SwapItems(index, index - 1);
 			RenumberFavorites(index - 1);
+			fFavoritesDirty = true;
+			_ScheduleAutosave();
 			break;
 		}
 		case UPDATE_FAV_DISPLAY:
 		{
-			fFavorites->Invalidate();
+			// only the edited favorite's row shows a new title
+			FavItem* item = fEditedFavorite;
+			fEditedFavorite = NULL;
+			const char* title;
+			if (item == NULL || message->FindString("title", &title) != B_OK)
+				break;
+			item->SetTitle(title);
+			fFavorites->InvalidateItem(fFavorites->IndexOf(item));
+			if (_IsFiltering())
+				_InvalidateFilter();
+			fFavoritesDirty = true;
+			_ScheduleAutosave();
 			break;
 		}
 		case SWITCHLIST:
@@ -499,9 +993,7 @@ MainWindow::MessageReceived(BMessage* message)
 					fFavorites->MakeFocus(true);
 				if (listview == 1)
 					fHistory->MakeFocus(true);
-
-				fFavorites->Invalidate();
-				fHistory->Invalidate();
+				// the views redraw their selected rows when focus changes
 			}
 			break;
 		}
@@ -527,14 +1019,12 @@ MainWindow::MessageReceived(BMessage* message)
 			if (fHistory->IsFocus() && !fHistory->IsEmpty()) {
 				int32 index = fHistory->CurrentSelection();
 				ClipItem* item = dynamic_cast<ClipItem *> (fHistory->ItemAt(index));
-				BString text(item->GetClip());
-				PutClipboard(text);
+				PutClipboard(item->GetClipData());
 
 			} else if (fFavorites->IsFocus() && !fFavorites->IsEmpty()) {
 				int32 index = fFavorites->CurrentSelection();
 				FavItem* item = dynamic_cast<FavItem *> (fFavorites->ItemAt(index));
-				BString text(item->GetClip());
-				PutClipboard(text);
+				PutClipboard(item->GetClipData());
 
 			} else
 				break;
@@ -564,10 +1054,41 @@ MainWindow::MessageReceived(BMessage* message)
 		}
 		case CLEAR_HISTORY:
 		{
+			_FinishLoading(true);
+			fJournal.Clear();
 			fHistory->MakeEmpty();
+			_InvalidateFilter();
+			fFades.MakeEmpty();
+			int32 count = fHistoryList.CountItems();
+			fHistoryList.MakeEmpty();
+			if (!_IsFiltering())
+				fHistory->ItemsRemoved(0, count);
 			PostMessage(B_CLIPBOARD_CHANGED);
 			break;
 		}
+		case HISTORY_LOADED:
+		{
+			_AppendLoadedItems();
+			if (fLoading && message->GetBool("done", false)) {
+				_FinishLoading();
+				if (fJournal.NeedsCompaction())
+					_SaveHistory();
+			}
+			break;
+		}
+		case COMPACT_HISTORY:
+		{
+			if (fJournal.NeedsCompaction() && _SaveHistory() == B_OK)
+				fFavoritesDirty = false;
+			else
+				fClips.DeleteSpillFiles(fJournal.SavedGeneration());
+			break;
+		}
+		case AUTOSAVE:
+		{
+			_Autosave();
+			break;
+		}
 		case SETTINGS:
 		{
 			fSettingsWindow = new SettingsWindow(Frame());
@@ -576,59 +1097,73 @@ MainWindow::MessageReceived(BMessage* message)
 		}
 		case INSERT_HISTORY:
 		{
+			if (fHistory->CountSelected() > 1) {
+				_PasteSelection(0);
+				break;
+			}
 			int32 itemindex;
 			message->FindInt32("index", &itemindex);
-			if ((fHistory->IsEmpty()) || (itemindex < 0))
-				break;
-
-			Minimize(true);
-			be_clipboard->StopWatching(this);
-
 			ClipItem* item = dynamic_cast<ClipItem *> (fHistory->ItemAt(itemindex));
-			BString text(item->GetClip());
-			PutClipboard(text);
-			if (fAutoPaste)
-				AutoPaste();
-			MoveClipToTop();
-			UpdateColors();
-
-			be_clipboard->StartWatching(this);
+			if (item != NULL)
+				_PasteClip(item);
 			break;
 		}
 		case INSERT_FAVORITE:
 		{
+			// F-keys count all favorites, clicks only the ones shown
 			int32 itemindex;
 			message->FindInt32("index", &itemindex);
-			if ((fFavorites->IsEmpty()) || (itemindex < 0) ||
-				(fFavorites->CountItems() <= itemindex))
-				break;
-
-			Minimize(true);
-
-			FavItem* item = dynamic_cast<FavItem *> (fFavorites->ItemAt(itemindex));
-			BString text(item->GetClip());
-			PutClipboard(text);
-			if (fAutoPaste)
-				AutoPaste();
+			FavItem* item;
+			if (message->HasPointer("source"))
+				item = dynamic_cast<FavItem *> (fFavorites->ItemAt(itemindex));
+			else
+				item = (FavItem*)fFavoriteList.ItemAt(itemindex);
+			if (item != NULL)
+				_PasteFavorite(item);
 			break;
 		}
 		case UPDATE_SETTINGS:
 		{
+			_ScheduleAutosave();
+
 			bool invisible = fPauseCheckBox->IsHidden();
 			int32 newValue;
 			if (message->FindInt32("limit", &newValue) == B_OK) {
 				if (fLimit >= newValue)
 					CropHistory(newValue);
 
-				if (fLimit != newValue)
+				if (fLimit != newValue) {
 					fLimit = newValue;
-
-				BMessenger messenger(fHistory);
-				BMessage message(ADJUSTCOLORS);
-				messenger.SendMessage(&message);
+					fHistoryList.SetCapacity(fLimit);
+				}
+			}
+			_LoadFadeSettings();
+			bool enforce = false;
+			if (message->FindInt32("memorylimit", &newValue) == B_OK) {
+				off_t limit = (off_t)newValue * 1024 * 1024;
+				enforce = limit != fMemoryLimit;
+				fMemoryLimit = limit;
+			}
+			if (message->FindInt32("spillthreshold", &newValue) == B_OK)
+				fClips.SetSpillThreshold((size_t)newValue * 1024 * 1024);
+			if (message->FindInt32("eviction", &newValue) == B_OK) {
+				fHistoryList.SetEvictionPolicy(
+					EvictionPolicy::Create(newValue));
 			}
+			int32 quiet;
+			if (message->FindInt32("coalescequiet", &quiet) == B_OK
+				&& message->FindInt32("coalescelatency", &newValue) == B_OK
+				&& fIngest->Lock()) {
+				// the ingest looper reads them in its own thread
+				fIngest->SetCoalescing(quiet * 1000LL, newValue * 1000LL);
+				fIngest->Unlock();
+			}
+			if (enforce)
+				_EnforceMemoryLimit();
 			if (message->FindInt32("autopaste", &newValue) == B_OK)
 				fAutoPaste = newValue;
+			if (message->FindInt32("pastedelay", &newValue) == B_OK)
+				fPasteDelay = paste_delay(newValue);
 			if (message->FindInt32("fade", &newValue) == B_OK) {
 				if ((invisible) && (newValue == 1))
 					fPauseCheckBox->Show();
@@ -641,6 +1176,15 @@ MainWindow::MessageReceived(BMessage* message)
 			}
 			break;
 		}
+		case B_COUNT_PROPERTIES:
+		case B_GET_PROPERTY:
+		case B_DELETE_PROPERTY:
+		case B_EXECUTE_PROPERTY:
+		{
+			if (!_HandleScripting(message))
+				BWindow::MessageReceived(message);
+			break;
+		}
 		default:
 		{
 			BWindow::MessageReceived(message);
@@ -650,30 +1194,270 @@ MainWindow::MessageReceived(BMessage* message)
 }
 
 
-void
-MainWindow::MakeItemUnique(BString clip)
+BHandler*
+MainWindow::ResolveSpecifier(BMessage* message, int32 index,
+	BMessage* specifier, int32 what, const char* property)
 {
-	if (fHistory->IsEmpty())
-		return;
+	BPropertyInfo propertyInfo(kScriptingProperties);
+	if (propertyInfo.FindMatch(message, index, specifier, what, property) >= 0)
+		return this;
+
+	return BWindow::ResolveSpecifier(message, index, specifier, what,
+		property);
+}
+
+
+status_t
+MainWindow::GetSupportedSuites(BMessage* data)
+{
+	data->AddString("suites", kScriptingSuite);
+	BPropertyInfo propertyInfo(kScriptingProperties);
+	data->AddFlat("messages", &propertyInfo);
+	return BWindow::GetSupportedSuites(data);
+}
 
-	for (int i = 0; i < fHistory->CountItems(); i++) {
-		ClipItem *sItem =
-			dynamic_cast<ClipItem *> (fHistory->ItemAt(i));
-		BString *listItem = new BString(sItem->GetClip());
 
-		if (clip.Compare(*listItem) == 0)
-			fHistory->RemoveItem(i);
+bool
+MainWindow::_HandleScripting(BMessage* message)
+{
+	int32 index;
+	BMessage specifier;
+	int32 form;
+	const char* property;
+	if (message->GetCurrentSpecifier(&index, &specifier, &form, &property)
+			!= B_OK)
+		return false;
+
+	BMessage reply(B_REPLY);
+	status_t status;
+	if (strcmp(property, "History") == 0)
+		status = _ScriptHistory(message, &specifier, form, &reply);
+	else if (strcmp(property, "Favorites") == 0)
+		status = _ScriptFavorites(message, &specifier, form, &reply);
+	else if (strcmp(property, "Search") == 0
+		&& message->what == B_GET_PROPERTY)
+		status = _ScriptSearch(message, &specifier, &reply);
+	else if (strcmp(property, "Stats") == 0
+		&& message->what == B_GET_PROPERTY) {
+		BMessage stats;
+		_GetStats(&stats);
+		status = reply.AddMessage("result", &stats);
+	} else
+		return false;
+
+	if (status != B_OK) {
+		reply.what = B_MESSAGE_NOT_UNDERSTOOD;
+		reply.AddString("message", strerror(status));
 	}
+	reply.AddInt32("error", status);
+	message->SendReply(&reply);
+	return true;
+}
+
+
+// Which items of a list of total ones a scripting message is about.
+status_t
+MainWindow::_ScriptingRange(BMessage* message, BMessage* specifier,
+	int32 form, int32 total, int32& index, int32& count)
+{
+	switch (form) {
+		case B_DIRECT_SPECIFIER:
+			// a page of the list, the first one unless asked otherwise
+			index = message->GetInt32("offset", 0);
+			count = message->GetInt32("count", kScriptingPageSize);
+			break;
+		case B_INDEX_SPECIFIER:
+			index = specifier->GetInt32("index", -1);
+			count = 1;
+			break;
+		case B_REVERSE_INDEX_SPECIFIER:
+			index = total - specifier->GetInt32("index", 0);
+			count = 1;
+			break;
+		case B_RANGE_SPECIFIER:
+			index = specifier->GetInt32("index", -1);
+			count = specifier->GetInt32("range", 0);
+			break;
+		default:
+			return B_BAD_SCRIPT_SYNTAX;
+	}
+
+	// only a page may start right after the end, and be empty
+	if (index < 0 || count < 0 || index > total
+		|| (index == total && form != B_DIRECT_SPECIFIER))
+		return B_BAD_INDEX;
+
+	count = std::min(count, total - index);
+	return B_OK;
+}
+
+
+status_t
+MainWindow::_ScriptHistory(BMessage* message, BMessage* specifier,
+	int32 form, BMessage* reply)
+{
+	int32 total = fHistoryList.CountItems();
+	if (message->what == B_COUNT_PROPERTIES)
+		return reply->AddInt32("result", total);
+
+	int32 index;
+	int32 count;
+	status_t status = _ScriptingRange(message, specifier, form, total, index,
+		count);
+	if (status != B_OK)
+		return status;
+
+	switch (message->what) {
+		case B_GET_PROPERTY:
+			for (int32 i = index; i < index + count; i++)
+				_AddHistoryClip(reply, i);
+			return B_OK;
+
+		case B_DELETE_PROPERTY:
+			_RemoveClips(index, count);
+			if (fHistory->CurrentSelection() < 0 && !fHistory->IsEmpty())
+				fHistory->Select(std::min(index, fHistory->CountItems() - 1));
+			return B_OK;
+
+		case B_EXECUTE_PROPERTY:
+		{
+			if (count == 1) {
+				_PasteClip(fHistoryList.ClipAt(index));
+				return B_OK;
+			}
+			BList items;
+			for (int32 i = index; i < index + count; i++)
+				items.AddItem(fHistoryList.ClipAt(i));
+			_PasteSequence(items, message->GetInt32("separator", 0));
+			return B_OK;
+		}
+	}
+	return B_BAD_SCRIPT_SYNTAX;
+}
+
+
+status_t
+MainWindow::_ScriptFavorites(BMessage* message, BMessage* specifier,
+	int32 form, BMessage* reply)
+{
+	int32 total = fFavoriteList.CountItems();
+	if (message->what == B_COUNT_PROPERTIES)
+		return reply->AddInt32("result", total);
+
+	int32 index;
+	int32 count;
+	status_t status = _ScriptingRange(message, specifier, form, total, index,
+		count);
+	if (status != B_OK)
+		return status;
+
+	switch (message->what) {
+		case B_GET_PROPERTY:
+			for (int32 i = index; i < index + count; i++)
+				_AddFavorite(reply, i);
+			return B_OK;
+
+		case B_DELETE_PROPERTY:
+			_RemoveFavorites(index, count);
+			if (fFavorites->CurrentSelection() < 0 && !fFavorites->IsEmpty())
+				fFavorites->Select(0);
+			return B_OK;
+
+		case B_EXECUTE_PROPERTY:
+			_PasteFavorite((FavItem*)fFavoriteList.ItemAt(index));
+			return B_OK;
+	}
+	return B_BAD_SCRIPT_SYNTAX;
+}
+
+
+status_t
+MainWindow::_ScriptSearch(BMessage* message, BMessage* specifier,
+	BMessage* reply)
+{
+	const char* query;
+	if (specifier->FindString("name", &query) != B_OK || query[0] == '\0')
+		return B_BAD_VALUE;
+
+	int32 count = message->GetInt32("count", kScriptingPageSize);
+	if (count <= 0)
+		return B_BAD_VALUE;
+
+	// filters of their own, the window's keep what the user typed
+	BList matches(count);
+	ClipFilter historyFilter(clip_item_text);
+	historyFilter.Filter(query, fHistoryList, matches, count);
+	for (int32 i = 0; i < matches.CountItems(); i++) {
+		_AddHistoryClip(reply,
+			fHistoryList.IndexOf((ClipItem*)matches.ItemAt(i)));
+		reply->AddString("list", "history");
+	}
+
+	ClipFilter favoriteFilter(fav_item_text, fav_item_title);
+	favoriteFilter.Filter(query, PlainListModel(fFavoriteList), matches,
+		count);
+	for (int32 i = 0; i < matches.CountItems(); i++) {
+		_AddFavorite(reply, fFavoriteList.IndexOf(matches.ItemAt(i)));
+		reply->AddString("list", "favorites");
+	}
+	return B_OK;
 }
 
 
 void
-MainWindow::AddClip(BString clip, BString path, int32 time)
+MainWindow::_AddHistoryClip(BMessage* reply, int32 index)
 {
-	if (fHistory->CountItems() > fLimit - 1)
-		fHistory->RemoveItem(fHistory->LastItem());
+	ClipItem* item = fHistoryList.ClipAt(index);
+
+	BString buffer;
+	size_t length;
+	const char* text = item->GetClipData()->GetText(buffer, length);
+	reply->AddString("result", BString(text, length));
+	reply->AddString("title", item->GetClipTitle());
+	reply->AddString("origin", item->GetOrigin());
+	reply->AddInt32("time", item->GetTimeAdded());
+	reply->AddInt32("index", index);
+}
+
 
-	fHistory->AddItem(new ClipItem(clip, path, time), 0);
+void
+MainWindow::_AddFavorite(BMessage* reply, int32 index)
+{
+	FavItem* item = (FavItem*)fFavoriteList.ItemAt(index);
+
+	BString buffer;
+	size_t length;
+	const char* text = item->GetClipData()->GetText(buffer, length);
+	reply->AddString("result", BString(text, length));
+	reply->AddString("title", item->GetTitle());
+	reply->AddInt32("index", index);
+}
+
+
+void
+MainWindow::MakeItemUnique(ClipData* clip)
+{
+	int32 index = fHistoryList.IndexOf(clip);
+	if (index >= 0)
+		_RemoveClips(index, 1);
+}
+
+
+void
+MainWindow::AddClip(ClipItem* item)
+{
+	if (fHistoryList.CountItems() > fLimit - 1)
+		_RemoveClips(fHistoryList.CountItems() - 1, 1);
+
+	fFades.Add(item, real_time_clock());
+	_ScheduleFade();
+	fJournal.AddClip(item->GetClipData(), item->GetOrigin(),
+		item->GetTimeAdded());
+	fHistoryList.AddFirst(item);
+	if (_IsFiltering())
+		_InvalidateFilter();
+	else
+		fHistory->ItemsAdded(0, 1);
 }
 
 
@@ -685,18 +1469,24 @@ MainWindow::AddFav()
 		return;
 
 	ClipItem *item = dynamic_cast<ClipItem *> (fHistory->ItemAt(index));
-	BString clip(item->GetClip());
 
-	int32 lastitem = fFavorites->CountItems();
-	fFavorites->AddItem(new FavItem(clip, NULL, lastitem), lastitem);
+	// the favorite shares the clip text with the history
+	int32 lastitem = fFavoriteList.CountItems();
+	FavItem* fav = new FavItem(item->GetClipData(), BString(), lastitem);
+	fFavoriteList.AddItem(fav);
+	fHistoryList.AddFavorite(fav->GetClipData());
+	if (_IsFiltering())
+		_InvalidateFilter();
+	else
+		fFavorites->AddItem(fav);
 }
 
 
 void
 MainWindow::RenumberFavorites(int32 start)
 {
-	for (start; start < fFavorites->CountItems(); start++) {
-		FavItem *item = dynamic_cast<FavItem *> (fFavorites->ItemAt(start));
+	for (start; start < fFavoriteList.CountItems(); start++) {
+		FavItem *item = (FavItem*)fFavoriteList.ItemAt(start);
 		item->SetFavNumber(start);
 	}
 }
@@ -706,43 +1496,47 @@ void
 MainWindow::CropHistory(int32 limit)
 {
 	if (limit < fLimit) {
-		if (fHistory->CountItems() > limit) {
-			int count = fHistory->CountItems() - limit - 1;
+		if (fHistoryList.CountItems() > limit) {
+			int count = fHistoryList.CountItems() - limit - 1;
 			if (limit == 0)
 				limit = 1;
-			fHistory->RemoveItems(limit, count);
+			_RemoveClips(limit, count);
 		}
 	}
 }
 
 
-BString
-MainWindow::GetClipboard()
+bool
+MainWindow::HasClipboardText()
 {
-	const char* text;
-	ssize_t textLen;
-	BMessage* clipboard;
+	// only looks, the text may be huge
+	bool hasText = false;
 	if (be_clipboard->Lock()) {
-		if ((clipboard = be_clipboard->Data()))
-			clipboard->FindData("text/plain", B_MIME_TYPE,
-				(const void **)&text, &textLen);
+		BMessage* clipboard = be_clipboard->Data();
+		const char* text;
+		ssize_t textLen;
+		hasText = clipboard != NULL && clipboard->FindData("text/plain",
+			B_MIME_TYPE, (const void **)&text, &textLen) == B_OK
+			&& textLen > 0 && text[0] != '\0';
 		be_clipboard->Unlock();
 	}
-	BString clip(text, textLen);
-	return clip;
+	return hasText;
 }
 
 
 void
-MainWindow::PutClipboard(BString text)
+MainWindow::PutClipboard(ClipData* data)
 {
-	ssize_t textLen = text.Length();
+	// plain texts go right from the clip into the clipboard
+	BString buffer;
+	size_t textLen;
+	const char* text = data->GetText(buffer, textLen);
 	BMessage* clip = (BMessage *)NULL;
 
 	if (be_clipboard->Lock()) {
 		be_clipboard->Clear();
 		if (clip = be_clipboard->Data()) {
-			clip->AddData("text/plain", B_MIME_TYPE, text.String(), textLen);
+			clip->AddData("text/plain", B_MIME_TYPE, text, textLen);
 			be_clipboard->Commit();
 		}
 		be_clipboard->Unlock();
@@ -753,28 +1547,314 @@ MainWindow::PutClipboard(BString text)
 void
 MainWindow::AutoPaste()
 {
-	port_id port = find_port(OUTPUT_PORT_NAME);
-	if (port != B_NAME_NOT_FOUND)
-		write_port(port, 'CtSV', NULL, 0);
+	// the input device answers with a PASTE_DONE
+	fPaste->RequestPaste();
 }
 
 
 void
-MainWindow::MoveClipToTop()
+MainWindow::MoveClipToTop(ClipItem* item)
 {
-	fHistory->MoveItem(fHistory->CurrentSelection(), 0);
-	fHistory->Select(0);
+	int32 index = fHistoryList.IndexOf(item);
+	if (index < 0)
+		return;
 
 	int32 time(real_time_clock());
-	ClipItem* item = dynamic_cast<ClipItem *> (fHistory->ItemAt(0));
-	item->SetTimeAdded(time);
+	fJournal.MoveClipToTop(index, time);
+
+	fHistoryList.MoveToFirst(index, time);
+	bool filtering = _IsFiltering();
+	if (filtering)
+		_InvalidateFilter();
+	else {
+		fHistory->ItemMoved(index, 0);
+		fHistory->Select(0);
+	}
+
+	// while filtering, the view is refilled anyway
+	if (fFades.Add(item, time) && !filtering)
+		fHistory->InvalidateItem(0);
+	_ScheduleFade();
 }
 
 
 void
-MainWindow::UpdateColors()
+MainWindow::_PasteClip(ClipItem* item)
 {
-	BMessenger messenger(fHistory);
+	_StopPasteSequence();
+	Minimize(true);
+	be_clipboard->StopWatching(this);
+
+	PutClipboard(item->GetClipData());
+	if (fAutoPaste)
+		AutoPaste();
+	_ClearFilter();
+	MoveClipToTop(item);
+
+	be_clipboard->StartWatching(this);
+}
+
+
+void
+MainWindow::_PasteFavorite(FavItem* item)
+{
+	_StopPasteSequence();
+	Minimize(true);
+
+	PutClipboard(item->GetClipData());
+	if (fAutoPaste)
+		AutoPaste();
+	_ClearFilter();
+}
+
+
+void
+MainWindow::_PasteSelection(char separator)
+{
+	// from top to bottom, as the clips are shown
+	BList items;
+	for (int32 i = 0; i < fHistory->CountSelected(); i++) {
+		ClipItem* item = dynamic_cast<ClipItem*>(
+			fHistory->ItemAt(fHistory->SelectedAt(i)));
+		if (item != NULL)
+			items.AddItem(item);
+	}
+	if (!items.IsEmpty())
+		_PasteSequence(items, separator);
+}
+
+
+void
+MainWindow::_PasteSequence(const BList& items, char separator)
+{
+	_StopPasteSequence();
+
+	// the clips stay in their place in the history, and are kept even if
+	// they're removed before it's their turn
+	for (int32 i = 0; i < items.CountItems(); i++) {
+		ClipData* clip = ((ClipItem*)items.ItemAt(i))->GetClipData();
+		clip->AcquireReference();
+		fPasteQueue.AddItem(clip);
+	}
+	fPasteSeparator = separator;
+
+	Minimize(true);
+	_ClearFilter();
+	_PasteNext();
+}
+
+
+void
+MainWindow::_PasteNext()
+{
+	_StopPasteTimer();
+
+	ClipData* clip = (ClipData*)fPasteQueue.RemoveItem((int32)0);
+	if (clip == NULL)
+		return;
+
+	be_clipboard->StopWatching(this);
+	PutClipboard(clip);
+	be_clipboard->StartWatching(this);
+	fClips.Collect(clip);
+	clip->ReleaseReference();
+
+	// the separator goes right behind the paste, the device keeps them in
+	// order and the clipboard isn't needed for it
+	int32 sequence = fPaste->RequestPaste();
+	if (sequence >= 0 && fPasteSeparator != 0 && !fPasteQueue.IsEmpty())
+		sequence = fPaste->RequestKey(fPasteSeparator);
+	if (sequence < 0) {
+		_StopPasteSequence();
+		return;
+	}
+
+	fPasteAwaited = sequence;
+	if (!fPasteQueue.IsEmpty())
+		_StartPasteTimer(PASTE_TIMEOUT, fPasteDelay);
+}
+
+
+void
+MainWindow::_StopPasteSequence()
+{
+	_StopPasteTimer();
+	fPasteAwaited = -1;
+
+	for (int32 i = 0; i < fPasteQueue.CountItems(); i++) {
+		ClipData* clip = (ClipData*)fPasteQueue.ItemAt(i);
+		fClips.Collect(clip);
+		clip->ReleaseReference();
+	}
+	fPasteQueue.MakeEmpty();
+}
+
+
+void
+MainWindow::_StartPasteTimer(uint32 what, bigtime_t delay)
+{
+	_StopPasteTimer();
+	BMessage message(what);
+	message.AddInt32("timer", fPasteTimer);
+	fPasteRunner = new BMessageRunner(this, &message, delay, 1);
+}
+
+
+void
+MainWindow::_StopPasteTimer()
+{
+	// what it already sent may still be queued, the new tag tells it apart
+	delete fPasteRunner;
+	fPasteRunner = NULL;
+	fPasteTimer++;
+}
+
+
+void
+MainWindow::_RemoveFavorites(int32 index, int32 count)
+{
+	// the views don't own the items, we do
+	for (int32 i = index + count - 1; i >= index; i--) {
+		FavItem* item = (FavItem*)fFavoriteList.ItemAt(i);
+		fFavorites->RemoveItem(item);
+		if (item == fEditedFavorite) {
+			fEditedFavorite = NULL;
+			fEditWindow.SendMessage(B_QUIT_REQUESTED);
+		}
+		ClipData* clip = item->GetClipData();
+		fHistoryList.RemoveFavorite(clip);
+		clip->AcquireReference();
+		delete item;
+		fClips.Collect(clip);
+		clip->ReleaseReference();
+	}
+	fFavoriteList.RemoveItems(index, count);
+	RenumberFavorites(index);
+	_InvalidateFilter();
+	fFavoritesDirty = true;
+	_ScheduleAutosave();
+}
+
+
+void
+MainWindow::_LoadFadeSettings()
+{
+	bool fade = false;
+	int32 delay = kDefaultFadeDelay;
+	int32 steps = kDefaultFadeStep;
+	float maxLevel = 1.0 + 0.025 * kDefaultFadeMaxLevel;
+	ClipdingerSettings* settings = my_app->Settings();
+	if (settings->Lock()) {
+		fade = settings->GetFade();
+		delay = settings->GetFadeDelay() * kMinuteUnits;
+		steps = settings->GetFadeStep();
+		maxLevel = 1.0 + 0.025 * settings->GetFadeMaxLevel();
+		settings->Unlock();
+	}
+
+	if (!fFades.SetSettings(fade, delay, steps, maxLevel))
+		return;
+
+	// every clip has to start over with the new tints
+	bigtime_t start = system_time();
+	int32 now = real_time_clock();
+	for (int32 i = 0; i < fHistoryList.CountItems(); i++)
+		fFades.Add(fHistoryList.ClipAt(i), now);
+	fFadeLatency.AddSince(start);
+	fHistory->Invalidate();
+	_ScheduleFade();
+}
+
+
+void
+MainWindow::_AdvanceFade()
+{
+	bool pause = false;
+	ClipdingerSettings* settings = my_app->Settings();
+	if (settings->Lock()) {
+		pause = settings->GetFadePause();
+		settings->Unlock();
+	}
+	if (pause)
+		return;
+
+	BList changed;
+	bigtime_t start = system_time();
+	fFades.Advance(real_time_clock(), changed);
+	fFadeTickLatency.AddSince(start);
+	fHistory->InvalidateItems(changed);
+	_ScheduleFade();
+}
+
+
+void
+MainWindow::_ScheduleFade()
+{
+	// a single shot at the next clip that fades a step
+	int32 deadline = fFades.NextDeadline();
+	if (deadline == fFadeDeadline)
+		return;
+
+	delete fFadeRunner;
+	fFadeRunner = NULL;
+	fFadeDeadline = deadline;
+	if (deadline == 0)
+		return;
+
+	bigtime_t delay = (bigtime_t)(deadline - real_time_clock()) * 1000000;
 	BMessage message(ADJUSTCOLORS);
-	messenger.SendMessage(&message);
+	fFadeRunner = new BMessageRunner(this, &message,
+		delay > 0 ? delay : 1000000, 1);
+}
+
+
+// What scripting gets for "get Stats": how much the history holds, how
+// often work was saved, and how long things took, in microseconds.
+void
+MainWindow::_GetStats(BMessage* stats)
+{
+	stats->AddInt32("history clips", fHistoryList.CountItems());
+	stats->AddInt32("favorites", fFavoriteList.CountItems());
+	stats->AddInt32("stored clips", fClips.CountClips());
+	stats->AddInt64("history bytes", fHistoryList.Bytes());
+	stats->AddInt64("dedup hits", fClips.CountDedupHits());
+	stats->AddInt32("clipboard changes", fIngest->CountChanges());
+	stats->AddInt32("coalesced changes", fIngest->CountCoalesced());
+
+	int64 hits;
+	int64 misses;
+	my_app->Icons()->GetCounters(&hits, &misses);
+	stats->AddInt64("icon cache hits", hits);
+	stats->AddInt64("icon cache misses", misses);
+
+	save_counters counters;
+	fJournal.GetCounters(&counters);
+	stats->AddInt64("saves", counters.saves);
+	stats->AddInt64("save failures", counters.failures);
+	stats->AddInt64("last save bytes", counters.lastBytes);
+	stats->AddInt64("journal bytes", counters.journalBytes);
+	stats->AddInt64("journal syncs", counters.journalSyncs);
+
+	int64 saves;
+	int64 failures;
+	int64 lastLatency;
+	int64 maxLatency;
+	int64 lastBytes;
+	my_app->Settings()->GetSaveCounters(&saves, &failures, &lastLatency,
+		&maxLatency, &lastBytes);
+	stats->AddInt64("settings saves", saves);
+	stats->AddInt64("settings save failures", failures);
+	stats->AddInt64("last settings save latency", lastLatency);
+	stats->AddInt64("max settings save latency", maxLatency);
+	stats->AddInt64("last settings save bytes", lastBytes);
+
+	stats->AddInt64("startup latency", fStartupLatency);
+	stats->AddInt64("load latency", fLoadLatency);
+	fIngestLatency.AddTo(stats, "ingest latency");
+	fJournal.SaveLatency().AddTo(stats, "save latency");
+	fFadeLatency.AddTo(stats, "fade recompute latency");
+	fFadeTickLatency.AddTo(stats, "fade tick latency");
+	fPasteLatency.AddTo(stats, "paste latency");
+	fSummonLatency.AddTo(stats, "summon to paste latency");
+	stats->AddInt64("paste gap", fPaste->Gap());
 }
@@ -18,20 +18,35 @@
 #include <Menu.h>
 #include <MenuBar.h>
 #include <MenuItem.h>
+#include <MessageRunner.h>
 #include <ScrollView.h>
 #include <Size.h>
 #include <SplitView.h>
 #include <String.h>
 #include <StringView.h>
+#include <TextControl.h>
 #include <Window.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <strings.h>
 
+#include <map>
+
+#include "ClipFilter.h"
+#include "ClipHistory.h"
+#include "ClipIngest.h"
+#include "ClipItem.h"
+#include "ClipStore.h"
 #include "ClipView.h"
 #include "EditWindow.h"
+#include "EvictionPolicy.h"
+#include "FadeSchedule.h"
+#include "FavItem.h"
 #include "FavView.h"
+#include "HistoryJournal.h"
+#include "LatencyHistogram.h"
+#include "PasteClient.h"
 #include "SettingsWindow.h"
 
 const int32	kControlKeys = B_COMMAND_KEY | B_SHIFT_KEY;
@@ -44,31 +59,82 @@ public:
 
 	bool			QuitRequested();
 	void			MessageReceived(BMessage* message);
+	virtual	void	WindowActivated(bool active);
+	virtual BHandler* ResolveSpecifier(BMessage* message, int32 index,
+						BMessage* specifier, int32 what,
+						const char* property);
+	virtual status_t GetSupportedSuites(BMessage* data);
 
 private:
 	void			_BuildLayout();
 	void			_LoadHistory();
-	void			_SaveHistory();
-	void			_LoadFavorites();
-	void			_SaveFavorites();
+	static status_t	_LoadRemainder(void* data);
+	void			_AppendLoadedItems();
+	void			_FinishLoading(bool discard = false);
+	status_t		_SaveHistory(bool wait = false);
+	void			_ScheduleAutosave();
+	void			_Autosave();
+	void			_RemoveClips(int32 index, int32 count);
+	void			_EnforceMemoryLimit();
 	void			_SetSplitview();
-
-	void			MakeItemUnique(BString clip);
-	void			AddClip(BString clip, BString path, int32 time);
+	bool			_IsFiltering();
+	void			_ApplyFilter();
+	void			_InvalidateFilter();
+	void			_ClearFilter();
+	void			_TypeToFilter(BMessage* message);
+	void			_LoadFadeSettings();
+	void			_AdvanceFade();
+	void			_ScheduleFade();
+	void			_PasteClip(ClipItem* item);
+	void			_PasteFavorite(FavItem* item);
+	void			_PasteSelection(char separator);
+	void			_PasteSequence(const BList& items, char separator);
+	void			_PasteNext();
+	void			_StopPasteSequence();
+	void			_StartPasteTimer(uint32 what, bigtime_t delay);
+	void			_StopPasteTimer();
+	void			_RemoveFavorites(int32 index, int32 count);
+
+	bool			_HandleScripting(BMessage* message);
+	status_t		_ScriptingRange(BMessage* message, BMessage* specifier,
+						int32 form, int32 total, int32& index,
+						int32& count);
+	status_t		_ScriptHistory(BMessage* message, BMessage* specifier,
+						int32 form, BMessage* reply);
+	status_t		_ScriptFavorites(BMessage* message,
+						BMessage* specifier, int32 form, BMessage* reply);
+	status_t		_ScriptSearch(BMessage* message, BMessage* specifier,
+						BMessage* reply);
+	void			_AddHistoryClip(BMessage* reply, int32 index);
+	void			_AddFavorite(BMessage* reply, int32 index);
+	void			_GetStats(BMessage* stats);
+
+	void			MakeItemUnique(ClipData* clip);
+	void			AddClip(ClipItem* item);
 	void			AddFav();
-	BString			GetClipboard();
-	void			PutClipboard(BString text);
+	bool			HasClipboardText();
+	void			PutClipboard(ClipData* data);
 	void			CropHistory(int32 limit);
 	void			AutoPaste();
-	void			MoveClipToTop();
-	void			UpdateColors();
+	void			MoveClipToTop(ClipItem* item);
 	void			RenumberFavorites(int32 start);
 
 	int32			fLimit;
+	off_t			fMemoryLimit;
 	int32			fAutoPaste;
 	int32			fLaunchTime;
+	bigtime_t		fStartupLatency;
+	bigtime_t		fLoadStart;
+	bigtime_t		fLoadLatency;
+	LatencyHistogram fIngestLatency;
+	LatencyHistogram fFadeLatency;
+	LatencyHistogram fFadeTickLatency;
+	LatencyHistogram fPasteLatency;
+	LatencyHistogram fSummonLatency;
+	bigtime_t		fSummonTime;
 
 	BSplitView*		fMainSplitView;
+	BTextControl*	fFilterControl;
 	ClipView*		fHistory;
 	FavView*		fFavorites;
 
@@ -79,7 +145,50 @@ private:
 	BButton*		fButtonUp;
 	BButton*		fButtonDown;
 
-	EditWindow*		fEditWindow;
+	ClipStore		fClips;
+	ClipIngest*		fIngest;
+	PasteClient*	fPaste;
+
+	// the clips still to be pasted in a row, each with a reference
+	BList			fPasteQueue;
+	char			fPasteSeparator;
+	int32			fPasteAwaited;
+	bigtime_t		fPasteDelay;
+	// only the message of the running timer, tagged with it, counts
+	BMessageRunner*	fPasteRunner;
+	int32			fPasteTimer;
+
+	// all clips and favorites, while filtering the views only show some
+	ClipHistory		fHistoryList;
+	BList			fFavoriteList;
+	ClipFilter		fHistoryFilter;
+	ClipFilter		fFavoriteFilter;
+	BString			fFilterText;
+	bool			fFilterPending;
+	HistoryJournal	fJournal;
+
+	// the part of the history that's loaded in the background
+	BList*			fPendingEntries;
+	int32			fPendingIndex;
+	int32			fQuitTime;
+	thread_id		fLoaderThread;
+	int32			fStopLoading;
+	int32			fLoadNotified;
+	BLocker			fLoadLock;
+	BList			fLoadedItems;
+	bool			fLoading;
+
+	BMessageRunner*	fCompactRunner;
+	BMessageRunner*	fAutosaveRunner;
+	bool			fFavoritesDirty;
+
+	FadeSchedule	fFades;
+	BMessageRunner*	fFadeRunner;
+	int32			fFadeDeadline;
+
+	// the favorite being edited, if it's still around
+	FavItem*		fEditedFavorite;
+	BMessenger		fEditWindow;
 	SettingsWindow*	fSettingsWindow;
 };
 
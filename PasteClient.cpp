@@ -0,0 +1,113 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <Message.h>
+
+#include <algorithm>
+
+#include "Constants.h"
+#include "PasteClient.h"
+#include "input_device/PasteProtocol.h"
+
+
+PasteClient::PasteClient(BMessenger target)
+	:
+	fTarget(target),
+	fReplyThread(-1),
+	fSequence(0),
+	fGap(kMaxPasteGap)
+{
+	fReplyPort = create_port(20, "Clipdinger paste replies");
+	if (fReplyPort < 0)
+		return;
+
+	fReplyThread = spawn_thread(_ReadReplies, "paste replies",
+		B_NORMAL_PRIORITY, this);
+	if (fReplyThread >= 0)
+		resume_thread(fReplyThread);
+}
+
+
+PasteClient::~PasteClient()
+{
+	// ends the reply thread as well
+	if (fReplyPort >= 0)
+		delete_port(fReplyPort);
+	if (fReplyThread >= 0) {
+		status_t result;
+		wait_for_thread(fReplyThread, &result);
+	}
+}
+
+
+int32
+PasteClient::RequestPaste()
+{
+	return _Request(0);
+}
+
+
+int32
+PasteClient::RequestKey(char key)
+{
+	return _Request(key);
+}
+
+
+int32
+PasteClient::_Request(int32 key)
+{
+	port_id port = find_port(OUTPUT_PORT_NAME);
+	if (port < 0)
+		return port;
+
+	paste_request request;
+	request.sequence = atomic_add(&fSequence, 1) + 1;
+	request.replyPort = fReplyPort;
+	request.requested = system_time();
+	request.gap = key == 0 ? Gap() : 0;
+	request.key = key;
+
+	// the device may be stuck, the window mustn't be
+	status_t status = write_port_etc(port, kPasteRequest, &request,
+		sizeof(request), B_RELATIVE_TIMEOUT, kPasteRequestTimeout);
+	return status == B_OK ? request.sequence : status;
+}
+
+
+/*static*/ status_t
+PasteClient::_ReadReplies(void* data)
+{
+	PasteClient* client = (PasteClient*)data;
+
+	int32 code;
+	paste_ack ack;
+	while (read_port(client->fReplyPort, &code, &ack, sizeof(ack)) >= 0) {
+		if (code != kPasteDone)
+			continue;
+
+		if (ack.waited > 0) {
+			// the gap is only changed here, after the paste that had it
+			bigtime_t gap = client->Gap();
+			bigtime_t late = ack.injected - ack.requested
+				+ std::max(ack.waited - gap, (bigtime_t)0);
+			if (late > gap / 4)
+				gap = std::min(gap * 2, kMaxPasteGap);
+			else
+				gap = std::max(gap - gap / 4, kMinPasteGap);
+			atomic_set64(&client->fGap, gap);
+		}
+
+		BMessage done(PASTE_DONE);
+		done.AddInt32("sequence", ack.sequence);
+		done.AddInt64("requested", ack.requested);
+		done.AddInt64("injected", ack.injected);
+		client->fTarget.SendMessage(&done);
+	}
+	return B_OK;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef PASTECLIENT_H
+#define PASTECLIENT_H
+
+#include <Messenger.h>
+#include <OS.h>
+
+
+// Asks the input device for pastes and passes its answers on to the
+// target as PASTE_DONE messages, with the "sequence" number of the
+// request and when it was "requested" and "injected".
+// The device gives the target the gap to take a paste before it answers.
+// There's no telling when the target did, but it's slow when the system
+// is busy, and so is the device: the gap doubles when it was late to
+// inject a paste or to wake up after the gap, and shrinks by a quarter
+// after every paste it handled in time, from kMaxPasteGap at first down
+// to kMinPasteGap.
+class PasteClient {
+public:
+						PasteClient(BMessenger target);
+						~PasteClient();
+
+	// returns the sequence number of the request, or an error
+	int32				RequestPaste();
+	// a single key without modifiers, like B_TAB
+	int32				RequestKey(char key);
+	bigtime_t			Gap() const { return atomic_get64(&fGap); };
+
+private:
+	int32				_Request(int32 key);
+	static status_t		_ReadReplies(void* data);
+
+	BMessenger			fTarget;
+	port_id				fReplyPort;
+	thread_id			fReplyThread;
+	int32				fSequence;
+	mutable int64		fGap;
+};
+
+#endif // PASTECLIENT_H
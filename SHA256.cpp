@@ -0,0 +1,173 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <string.h>
+
+#include "SHA256.h"
+
+static const uint32 kRoundConstants[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+	0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+	0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+	0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+	0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+static inline uint32
+rotate_right(uint32 value, int bits)
+{
+	return (value >> bits) | (value << (32 - bits));
+}
+
+
+SHA256::SHA256()
+{
+	Init();
+}
+
+
+void
+SHA256::Init()
+{
+	fState[0] = 0x6a09e667;
+	fState[1] = 0xbb67ae85;
+	fState[2] = 0x3c6ef372;
+	fState[3] = 0xa54ff53a;
+	fState[4] = 0x510e527f;
+	fState[5] = 0x9b05688c;
+	fState[6] = 0x1f83d9ab;
+	fState[7] = 0x5be0cd19;
+	fBufferLength = 0;
+	fLength = 0;
+}
+
+
+void
+SHA256::Update(const void* data, size_t length)
+{
+	const uint8* bytes = (const uint8*)data;
+	fLength += length;
+
+	if (fBufferLength > 0) {
+		size_t toCopy = min_c(length, sizeof(fBuffer) - fBufferLength);
+		memcpy(fBuffer + fBufferLength, bytes, toCopy);
+		fBufferLength += toCopy;
+		bytes += toCopy;
+		length -= toCopy;
+		if (fBufferLength < sizeof(fBuffer))
+			return;
+		_ProcessBlock(fBuffer);
+		fBufferLength = 0;
+	}
+
+	for (; length >= sizeof(fBuffer); length -= sizeof(fBuffer)) {
+		_ProcessBlock(bytes);
+		bytes += sizeof(fBuffer);
+	}
+
+	memcpy(fBuffer, bytes, length);
+	fBufferLength = length;
+}
+
+
+void
+SHA256::Final(uint8* digest)
+{
+	uint64 bits = fLength * 8;
+
+	fBuffer[fBufferLength++] = 0x80;
+	if (fBufferLength > 56) {
+		memset(fBuffer + fBufferLength, 0, sizeof(fBuffer) - fBufferLength);
+		_ProcessBlock(fBuffer);
+		fBufferLength = 0;
+	}
+	memset(fBuffer + fBufferLength, 0, 56 - fBufferLength);
+	for (int i = 0; i < 8; i++)
+		fBuffer[63 - i] = bits >> (i * 8);
+	_ProcessBlock(fBuffer);
+
+	for (int i = 0; i < 8; i++) {
+		digest[i * 4] = fState[i] >> 24;
+		digest[i * 4 + 1] = fState[i] >> 16;
+		digest[i * 4 + 2] = fState[i] >> 8;
+		digest[i * 4 + 3] = fState[i];
+	}
+	Init();
+}
+
+
+/*static*/ void
+SHA256::Digest(const void* data, size_t length, uint8* digest)
+{
+	SHA256 sha;
+	sha.Update(data, length);
+	sha.Final(digest);
+}
+
+
+void
+SHA256::_ProcessBlock(const uint8* block)
+{
+	uint32 w[64];
+	for (int i = 0; i < 16; i++) {
+		w[i] = ((uint32)block[i * 4] << 24) | ((uint32)block[i * 4 + 1] << 16)
+			| ((uint32)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+	}
+	for (int i = 16; i < 64; i++) {
+		uint32 s0 = rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18)
+			^ (w[i - 15] >> 3);
+		uint32 s1 = rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19)
+			^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	uint32 a = fState[0];
+	uint32 b = fState[1];
+	uint32 c = fState[2];
+	uint32 d = fState[3];
+	uint32 e = fState[4];
+	uint32 f = fState[5];
+	uint32 g = fState[6];
+	uint32 h = fState[7];
+
+	for (int i = 0; i < 64; i++) {
+		uint32 s1 = rotate_right(e, 6) ^ rotate_right(e, 11)
+			^ rotate_right(e, 25);
+		uint32 choice = (e & f) ^ (~e & g);
+		uint32 temp1 = h + s1 + choice + kRoundConstants[i] + w[i];
+		uint32 s0 = rotate_right(a, 2) ^ rotate_right(a, 13)
+			^ rotate_right(a, 22);
+		uint32 majority = (a & b) ^ (a & c) ^ (b & c);
+		uint32 temp2 = s0 + majority;
+
+		h = g;
+		g = f;
+		f = e;
+		e = d + temp1;
+		d = c;
+		c = b;
+		b = a;
+		a = temp1 + temp2;
+	}
+
+	fState[0] += a;
+	fState[1] += b;
+	fState[2] += c;
+	fState[3] += d;
+	fState[4] += e;
+	fState[5] += f;
+	fState[6] += g;
+	fState[7] += h;
+}
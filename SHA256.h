@@ -0,0 +1,36 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <SupportDefs.h>
+
+static const int32 kSHA256DigestSize = 32;
+
+
+class SHA256 {
+public:
+					SHA256();
+
+	void			Init();
+	void			Update(const void* data, size_t length);
+	void			Final(uint8* digest);
+
+	static void		Digest(const void* data, size_t length, uint8* digest);
+
+private:
+	void			_ProcessBlock(const uint8* block);
+
+	uint32			fState[8];
+	uint8			fBuffer[64];
+	size_t			fBufferLength;
+	uint64			fLength;
+};
+
+#endif // SHA256_H
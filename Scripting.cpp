@@ -0,0 +1,74 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include "Scripting.h"
+
+
+property_info kScriptingProperties[] = {
+	{ "History", { B_COUNT_PROPERTIES, 0 }, { B_DIRECT_SPECIFIER, 0 },
+		"count History: returns the number of clips in the history.", 0,
+		{ B_INT32_TYPE }
+	},
+	{ "History", { B_GET_PROPERTY, 0 }, { B_DIRECT_SPECIFIER,
+			B_INDEX_SPECIFIER, B_REVERSE_INDEX_SPECIFIER, B_RANGE_SPECIFIER,
+			0 },
+		"get History [index]: returns clips, newest first. Their texts are "
+		"the \"result\", with \"title\", \"origin\", \"time\" and \"index\" "
+		"of each. Without an index, \"offset\" and \"count\" pick a page, "
+		"the first 50 clips by default.", 0, { B_STRING_TYPE }
+	},
+	{ "History", { B_DELETE_PROPERTY, 0 }, { B_INDEX_SPECIFIER,
+			B_REVERSE_INDEX_SPECIFIER, B_RANGE_SPECIFIER, 0 },
+		"delete History [index]: removes clips from the history.", 0
+	},
+	{ "History", { B_EXECUTE_PROPERTY, 0 }, { B_INDEX_SPECIFIER,
+			B_REVERSE_INDEX_SPECIFIER, B_RANGE_SPECIFIER, 0 },
+		"execute History [index]: pastes a clip, as if it was picked from "
+		"the list. A range pastes its clips one after the other, with the "
+		"int32 \"separator\" key of the message, like B_TAB, between them.",
+		0
+	},
+
+	{ "Favorites", { B_COUNT_PROPERTIES, 0 }, { B_DIRECT_SPECIFIER, 0 },
+		"count Favorites: returns the number of favorites.", 0,
+		{ B_INT32_TYPE }
+	},
+	{ "Favorites", { B_GET_PROPERTY, 0 }, { B_DIRECT_SPECIFIER,
+			B_INDEX_SPECIFIER, B_REVERSE_INDEX_SPECIFIER, B_RANGE_SPECIFIER,
+			0 },
+		"get Favorites [index]: returns favorites, in the order of their "
+		"F-keys. Their texts are the \"result\", with \"title\" and "
+		"\"index\" of each. Without an index, \"offset\" and \"count\" "
+		"pick a page, the first 50 favorites by default.", 0,
+		{ B_STRING_TYPE }
+	},
+	{ "Favorites", { B_DELETE_PROPERTY, 0 }, { B_INDEX_SPECIFIER,
+			B_REVERSE_INDEX_SPECIFIER, B_RANGE_SPECIFIER, 0 },
+		"delete Favorites [index]: removes favorites.", 0
+	},
+	{ "Favorites", { B_EXECUTE_PROPERTY, 0 }, { B_INDEX_SPECIFIER,
+			B_REVERSE_INDEX_SPECIFIER, 0 },
+		"execute Favorites [index]: pastes a favorite, as if it was picked "
+		"from the list.", 0
+	},
+
+	{ "Search", { B_GET_PROPERTY, 0 }, { B_NAME_SPECIFIER, 0 },
+		"get Search \"query\": returns the best matches in history and "
+		"favorites, as the filter would show them. With their texts as the "
+		"\"result\", the \"list\" and \"index\" they're at, and their "
+		"\"title\". \"count\" limits them, to 50 by default.", 0,
+		{ B_STRING_TYPE }
+	},
+
+	{ "Stats", { B_GET_PROPERTY, 0 }, { B_DIRECT_SPECIFIER, 0 },
+		"get Stats: returns the counters, gauges and latencies (in "
+		"microseconds) of the history engine.", 0, { B_MESSAGE_TYPE }
+	},
+
+	{ 0 }
+};
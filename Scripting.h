@@ -0,0 +1,25 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef SCRIPTING_H
+#define SCRIPTING_H
+
+#include <PropertyInfo.h>
+
+#define kScriptingSuite "suite/vnd.Humdinger-Clipdinger"
+
+// clips returned at once when no range is asked for
+static const int32 kScriptingPageSize = 50;
+
+// The properties the application answers to, e.g. "hey Clipdinger get
+// History [0 to 49]" or "hey Clipdinger execute Favorites 2". They all
+// belong to the main window, the application only passes them on.
+// Indices are those of the complete lists, filtering doesn't change them.
+extern property_info kScriptingProperties[];
+
+#endif // SCRIPTING_H
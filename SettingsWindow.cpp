@@ -10,11 +10,14 @@
 #include <Catalog.h>
 #include <ControlLook.h>
 #include <LayoutBuilder.h>
+#include <MenuItem.h>
+#include <PopUpMenu.h>
 #include <SeparatorView.h>
 #include <SpaceLayoutItem.h>
 
 #include "App.h"
 #include "Constants.h"
+#include "EvictionPolicy.h"
 #include "SettingsWindow.h"
 
 #undef B_TRANSLATION_CONTEXT
@@ -31,7 +34,16 @@ SettingsWindow::SettingsWindow(BRect frame)
 	ClipdingerSettings* settings = my_app->Settings();
 	if (settings->Lock()) {
 		newLimit = originalLimit = settings->GetLimit();
+		newMemoryLimit = originalMemoryLimit = settings->GetMemoryLimit();
+		newEviction = originalEviction = settings->GetEviction();
+		newSpillThreshold = originalSpillThreshold
+			= settings->GetSpillThreshold();
+		newCoalesceQuiet = originalCoalesceQuiet
+			= settings->GetCoalesceQuiet();
+		newCoalesceLatency = originalCoalesceLatency
+			= settings->GetCoalesceLatency();
 		newAutoPaste = originalAutoPaste = settings->GetAutoPaste();
+		newPasteDelay = originalPasteDelay = settings->GetPasteDelay();
 		newFade = originalFade = settings->GetFade();
 		newFadeDelay = originalFadeDelay = settings->GetFadeDelay();
 		newFadeStep = originalFadeStep = settings->GetFadeStep();
@@ -44,6 +56,21 @@ SettingsWindow::SettingsWindow(BRect frame)
 	char string[4];
 	snprintf(string, sizeof(string), "%d", originalLimit);
 	fLimitControl->SetText(string);
+	char memory[16];
+	snprintf(memory, sizeof(memory), "%d", originalMemoryLimit);
+	fMemoryLimitControl->SetText(memory);
+	snprintf(memory, sizeof(memory), "%d", originalSpillThreshold);
+	fSpillControl->SetText(memory);
+	char time[16];
+	snprintf(time, sizeof(time), "%d", originalCoalesceQuiet);
+	fCoalesceQuietControl->SetText(time);
+	snprintf(time, sizeof(time), "%d", originalCoalesceLatency);
+	fCoalesceLatencyControl->SetText(time);
+	snprintf(time, sizeof(time), "%d", originalPasteDelay);
+	fPasteDelayControl->SetText(time);
+	BMenuItem* item = fEvictionField->Menu()->ItemAt(originalEviction);
+	if (item != NULL)
+		item->SetMarked(true);
 	fAutoPasteBox->SetValue(originalAutoPaste);
 	fFadeBox->SetValue(originalFade);
 	fDelaySlider->SetValue(originalFadeDelay);
@@ -80,7 +107,13 @@ SettingsWindow::RevertSettings()
 	ClipdingerSettings* settings = my_app->Settings();
 	if (settings->Lock()) {
 		settings->SetLimit(originalLimit);
+		settings->SetMemoryLimit(originalMemoryLimit);
+		settings->SetEviction(originalEviction);
+		settings->SetSpillThreshold(originalSpillThreshold);
+		settings->SetCoalescing(originalCoalesceQuiet,
+			originalCoalesceLatency);
 		settings->SetAutoPaste(originalAutoPaste);
+		settings->SetPasteDelay(originalPasteDelay);
 		settings->SetFade(originalFade);
 		settings->SetFadeDelay(originalFadeDelay);
 		settings->SetFadeStep(originalFadeStep);
@@ -88,7 +121,13 @@ SettingsWindow::RevertSettings()
 		settings->Unlock();
 	}
 	newLimit = originalLimit;
+	newMemoryLimit = originalMemoryLimit;
+	newEviction = originalEviction;
+	newSpillThreshold = originalSpillThreshold;
+	newCoalesceQuiet = originalCoalesceQuiet;
+	newCoalesceLatency = originalCoalesceLatency;
 	newAutoPaste = originalAutoPaste;
+	newPasteDelay = originalPasteDelay;
 	newFade = originalFade;
 	newFadeDelay = originalFadeDelay;
 	newFadeStep = originalFadeStep;
@@ -102,7 +141,13 @@ SettingsWindow::UpdateSettings()
 	BMessenger messenger(my_app->fMainWindow);
 	BMessage message(UPDATE_SETTINGS);
 	message.AddInt32("limit", newLimit);
+	message.AddInt32("memorylimit", newMemoryLimit);
+	message.AddInt32("eviction", newEviction);
+	message.AddInt32("spillthreshold", newSpillThreshold);
+	message.AddInt32("coalescequiet", newCoalesceQuiet);
+	message.AddInt32("coalescelatency", newCoalesceLatency);
 	message.AddInt32("autopaste", newAutoPaste);
+	message.AddInt32("pastedelay", newPasteDelay);
 	message.AddInt32("fade", newFade);
 	messenger.SendMessage(&message);
 }
@@ -154,10 +199,83 @@ SettingsWindow::_BuildLayout()
 	BStringView* limitlabel = new BStringView("limitlabel",
 		B_TRANSLATE("entries in the clipboard history"));
 
+	// Memory limit
+	fMemoryLimitControl = new BTextControl("memorylimitfield", NULL, "",
+		NULL);
+	fMemoryLimitControl->SetAlignment(B_ALIGN_CENTER, B_ALIGN_CENTER);
+	for (uint32 i = 0; i < '0'; i++)
+		fMemoryLimitControl->TextView()->DisallowChar(i);
+	for (uint32 i = '9' + 1; i < 255; i++)
+		fMemoryLimitControl->TextView()->DisallowChar(i);
+
+	BStringView* memorylabel = new BStringView("memorylabel",
+		B_TRANSLATE("MiB of memory at most (0 for no limit)"));
+
+	BPopUpMenu* evictionMenu = new BPopUpMenu("eviction");
+	const char* policies[] = {
+		B_TRANSLATE("Oldest clips"),
+		B_TRANSLATE("Largest clips"),
+		B_TRANSLATE("Least pasted clips")
+	};
+	for (int32 i = kEvictOldest; i <= kEvictLeastPasted; i++) {
+		BMessage* message = new BMessage(EVICTION);
+		message->AddInt32("policy", i);
+		evictionMenu->AddItem(new BMenuItem(policies[i], message));
+	}
+	fEvictionField = new BMenuField("evictionfield",
+		B_TRANSLATE("When full, remove first:"), evictionMenu);
+
+	// Spilling to disk
+	fSpillControl = new BTextControl("spillfield", NULL, "", NULL);
+	fSpillControl->SetAlignment(B_ALIGN_CENTER, B_ALIGN_CENTER);
+	for (uint32 i = 0; i < '0'; i++)
+		fSpillControl->TextView()->DisallowChar(i);
+	for (uint32 i = '9' + 1; i < 255; i++)
+		fSpillControl->TextView()->DisallowChar(i);
+
+	BStringView* spilllabel = new BStringView("spilllabel",
+		B_TRANSLATE("MiB and larger clips are kept on disk (0 for never)"));
+
+	// Coalescing bursts of clipboard changes
+	fCoalesceQuietControl = new BTextControl("coalescequietfield", NULL, "",
+		NULL);
+	fCoalesceQuietControl->SetAlignment(B_ALIGN_CENTER, B_ALIGN_CENTER);
+	for (uint32 i = 0; i < '0'; i++)
+		fCoalesceQuietControl->TextView()->DisallowChar(i);
+	for (uint32 i = '9' + 1; i < 255; i++)
+		fCoalesceQuietControl->TextView()->DisallowChar(i);
+
+	BStringView* coalescequietlabel = new BStringView("coalescequietlabel",
+		B_TRANSLATE("ms without another copy before a clip is taken "
+		"(0 for every copy)"));
+
+	fCoalesceLatencyControl = new BTextControl("coalescelatencyfield", NULL,
+		"", NULL);
+	fCoalesceLatencyControl->SetAlignment(B_ALIGN_CENTER, B_ALIGN_CENTER);
+	for (uint32 i = 0; i < '0'; i++)
+		fCoalesceLatencyControl->TextView()->DisallowChar(i);
+	for (uint32 i = '9' + 1; i < 255; i++)
+		fCoalesceLatencyControl->TextView()->DisallowChar(i);
+
+	BStringView* coalescelatencylabel = new BStringView(
+		"coalescelatencylabel",
+		B_TRANSLATE("ms at most, while copies keep coming"));
+
 	// Auto-paste
 	fAutoPasteBox = new BCheckBox("autopaste", B_TRANSLATE(
 		"Auto-paste"), new BMessage(AUTOPASTE));
 
+	// Pasting several clips in a row
+	fPasteDelayControl = new BTextControl("pastedelayfield", NULL, "", NULL);
+	fPasteDelayControl->SetAlignment(B_ALIGN_CENTER, B_ALIGN_CENTER);
+	for (uint32 i = 0; i < '0'; i++)
+		fPasteDelayControl->TextView()->DisallowChar(i);
+	for (uint32 i = '9' + 1; i < 255; i++)
+		fPasteDelayControl->TextView()->DisallowChar(i);
+
+	BStringView* pastedelaylabel = new BStringView("pastedelaylabel",
+		B_TRANSLATE("ms per clip pasted in a row, if unconfirmed"));
+
 	// Fading
 	fFadeBox = new BCheckBox("fading", B_TRANSLATE(
 		"Fade history entries over time"), new BMessage(FADE));
@@ -214,9 +332,44 @@ SettingsWindow::_BuildLayout()
 			.Add(limitlabel)
 			.Add(BSpaceLayoutItem::CreateHorizontalStrut(spacing * 4))
 		.End()
+		.AddGroup(B_HORIZONTAL)
+			.SetInsets(spacing, 0, spacing, 0)
+			.Add(fMemoryLimitControl)
+			.Add(memorylabel)
+			.AddGlue()
+		.End()
+		.AddGroup(B_HORIZONTAL)
+			.SetInsets(spacing, 0, spacing, 0)
+			.Add(fEvictionField)
+			.AddGlue()
+		.End()
+		.AddGroup(B_HORIZONTAL)
+			.SetInsets(spacing, 0, spacing, 0)
+			.Add(fSpillControl)
+			.Add(spilllabel)
+			.AddGlue()
+		.End()
+		.AddGroup(B_HORIZONTAL)
+			.SetInsets(spacing, 0, spacing, 0)
+			.Add(fCoalesceQuietControl)
+			.Add(coalescequietlabel)
+			.AddGlue()
+		.End()
+		.AddGroup(B_HORIZONTAL)
+			.SetInsets(spacing, 0, spacing, spacing)
+			.Add(fCoalesceLatencyControl)
+			.Add(coalescelatencylabel)
+			.AddGlue()
+		.End()
 		.AddGroup(B_VERTICAL)
 			.SetInsets(spacing, 0, spacing, spacing)
 			.Add(fAutoPasteBox)
+			.AddGroup(B_HORIZONTAL)
+				.Add(BSpaceLayoutItem::CreateHorizontalStrut(spacing))
+				.Add(fPasteDelayControl)
+				.Add(pastedelaylabel)
+				.AddGlue()
+			.End()
 			.Add(fFadeBox)
 			.AddGroup(B_HORIZONTAL)
 				.Add(BSpaceLayoutItem::CreateHorizontalStrut(spacing))
@@ -307,6 +460,11 @@ SettingsWindow::MessageReceived(BMessage* message)
 			UpdateSettings();
 			break;
 		}
+		case EVICTION:
+		{
+			message->FindInt32("policy", &newEviction);
+			break;
+		}
 		case CANCEL:
 		{
 			RevertSettings();
@@ -317,9 +475,19 @@ SettingsWindow::MessageReceived(BMessage* message)
 		case OK:
 		{
 			newLimit = atoi(fLimitControl->Text());
+			newMemoryLimit = atoi(fMemoryLimitControl->Text());
+			newSpillThreshold = atoi(fSpillControl->Text());
+			newCoalesceQuiet = atoi(fCoalesceQuietControl->Text());
+			newCoalesceLatency = atoi(fCoalesceLatencyControl->Text());
+			newPasteDelay = atoi(fPasteDelayControl->Text());
 			if (settings->Lock()) {
 				settings->SetLimit(newLimit);
+				settings->SetMemoryLimit(newMemoryLimit);
+				settings->SetEviction(newEviction);
+				settings->SetSpillThreshold(newSpillThreshold);
+				settings->SetCoalescing(newCoalesceQuiet, newCoalesceLatency);
 				settings->SetAutoPaste(newAutoPaste);
+				settings->SetPasteDelay(newPasteDelay);
 				settings->SetFade(newFade);
 				settings->SetFadeDelay(newFadeDelay);
 				settings->SetFadeStep(newFadeStep);
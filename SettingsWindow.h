@@ -10,6 +10,7 @@
 #define SETTINGS_WINDOW_H
 
 #include <CheckBox.h>
+#include <MenuField.h>
 #include <Slider.h>
 #include <TextControl.h>
 #include <TextView.h>
@@ -30,8 +31,14 @@ public:
 
 private:
 	BTextControl*	fLimitControl;
+	BTextControl*	fMemoryLimitControl;
+	BMenuField*		fEvictionField;
+	BTextControl*	fSpillControl;
+	BTextControl*	fCoalesceQuietControl;
+	BTextControl*	fCoalesceLatencyControl;
 	BCheckBox*		fFadeBox;
 	BCheckBox*		fAutoPasteBox;
+	BTextControl*	fPasteDelayControl;
 	BSlider*		fDelaySlider;
 	BSlider*		fStepSlider;
 	BSlider*		fLevelSlider;
@@ -39,14 +46,26 @@ private:
 	BString*		fFadeDescription;
 
 	int32			originalLimit;
+	int32			originalMemoryLimit;
+	int32			originalEviction;
+	int32			originalSpillThreshold;
+	int32			originalCoalesceQuiet;
+	int32			originalCoalesceLatency;
 	int32			originalAutoPaste;
+	int32			originalPasteDelay;
 	int32			originalFade;
 	int32			originalFadeDelay;
 	int32			originalFadeStep;
 	int32			originalFadeMaxLevel;
 
 	int32			newLimit;
+	int32			newMemoryLimit;
+	int32			newEviction;
+	int32			newSpillThreshold;
+	int32			newCoalesceQuiet;
+	int32			newCoalesceLatency;
 	int32			newAutoPaste;
+	int32			newPasteDelay;
 	int32			newFade;
 	int32			newFadeDelay;
 	int32			newFadeStep;
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <string.h>
+
+#include "TextScan.h"
+
+#if defined(__SSE2__)
+#	include <emmintrin.h>
+#	define SCAN_SSE2 1
+#endif
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__)) \
+	&& defined(__GNUC__) && __GNUC__ >= 5
+#	include <immintrin.h>
+#	define SCAN_AVX2 1
+#	define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+
+
+static inline uint8
+fold_case(uint8 byte)
+{
+	return byte >= 'A' && byte <= 'Z' ? byte + ('a' - 'A') : byte;
+}
+
+
+static inline uint8
+upper_case(uint8 byte)
+{
+	return byte >= 'a' && byte <= 'z' ? byte - ('a' - 'A') : byte;
+}
+
+
+// compares the rest of a candidate whose first and last byte matched
+static inline bool
+equals_no_case(const char* text, const char* needle, size_t length)
+{
+	for (size_t i = 1; i + 1 < length; i++) {
+		if (fold_case(text[i]) != (uint8)needle[i])
+			return false;
+	}
+	return true;
+}
+
+
+static inline int32
+lowest_bit(uint32 mask)
+{
+	return __builtin_ctz(mask);
+}
+
+
+#ifdef SCAN_AVX2
+
+static bool
+has_avx2()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+
+static const bool kHasAVX2 = has_avx2();
+
+
+AVX2_FUNCTION static const char*
+find_any_byte_avx2(const char* text, size_t length, const char* needles,
+	int32 count)
+{
+	__m256i needle[kMaxScanNeedles];
+	for (int32 i = 0; i < kMaxScanNeedles; i++)
+		needle[i] = _mm256_set1_epi8(needles[i < count ? i : 0]);
+
+	size_t i = 0;
+	for (; i + 32 <= length; i += 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+		__m256i found = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, needle[0]),
+				_mm256_cmpeq_epi8(block, needle[1])),
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, needle[2]),
+				_mm256_cmpeq_epi8(block, needle[3])));
+		uint32 mask = _mm256_movemask_epi8(found);
+		if (mask != 0)
+			return text + i + lowest_bit(mask);
+	}
+	return TextScan::FindAnyByteScalar(text + i, length - i, needles, count);
+}
+
+
+AVX2_FUNCTION static const char*
+find_no_case_avx2(const char* text, size_t length, const char* needle,
+	size_t needleLength)
+{
+	const __m256i firstLower = _mm256_set1_epi8(needle[0]);
+	const __m256i firstUpper = _mm256_set1_epi8(upper_case(needle[0]));
+	const __m256i lastLower = _mm256_set1_epi8(needle[needleLength - 1]);
+	const __m256i lastUpper = _mm256_set1_epi8(
+		upper_case(needle[needleLength - 1]));
+
+	// candidates are where the first and the last byte match
+	size_t i = 0;
+	for (; i + needleLength - 1 + 32 <= length; i += 32) {
+		__m256i first = _mm256_loadu_si256((const __m256i*)(text + i));
+		__m256i last = _mm256_loadu_si256(
+			(const __m256i*)(text + i + needleLength - 1));
+		__m256i found = _mm256_and_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(first, firstLower),
+				_mm256_cmpeq_epi8(first, firstUpper)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(last, lastLower),
+				_mm256_cmpeq_epi8(last, lastUpper)));
+		uint32 mask = _mm256_movemask_epi8(found);
+		while (mask != 0) {
+			int32 bit = lowest_bit(mask);
+			if (equals_no_case(text + i + bit, needle, needleLength))
+				return text + i + bit;
+			mask &= mask - 1;
+		}
+	}
+	return TextScan::FindNoCaseScalar(text + i, length - i, needle,
+		needleLength);
+}
+
+#endif	// SCAN_AVX2
+
+
+#ifdef SCAN_SSE2
+
+static const char*
+find_any_byte_sse2(const char* text, size_t length, const char* needles,
+	int32 count)
+{
+	__m128i needle[kMaxScanNeedles];
+	for (int32 i = 0; i < kMaxScanNeedles; i++)
+		needle[i] = _mm_set1_epi8(needles[i < count ? i : 0]);
+
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16) {
+		__m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+		__m128i found = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(block, needle[0]),
+				_mm_cmpeq_epi8(block, needle[1])),
+			_mm_or_si128(_mm_cmpeq_epi8(block, needle[2]),
+				_mm_cmpeq_epi8(block, needle[3])));
+		uint32 mask = _mm_movemask_epi8(found);
+		if (mask != 0)
+			return text + i + lowest_bit(mask);
+	}
+	return TextScan::FindAnyByteScalar(text + i, length - i, needles, count);
+}
+
+
+static const char*
+find_no_case_sse2(const char* text, size_t length, const char* needle,
+	size_t needleLength)
+{
+	const __m128i firstLower = _mm_set1_epi8(needle[0]);
+	const __m128i firstUpper = _mm_set1_epi8(upper_case(needle[0]));
+	const __m128i lastLower = _mm_set1_epi8(needle[needleLength - 1]);
+	const __m128i lastUpper = _mm_set1_epi8(
+		upper_case(needle[needleLength - 1]));
+
+	size_t i = 0;
+	for (; i + needleLength - 1 + 16 <= length; i += 16) {
+		__m128i first = _mm_loadu_si128((const __m128i*)(text + i));
+		__m128i last = _mm_loadu_si128(
+			(const __m128i*)(text + i + needleLength - 1));
+		__m128i found = _mm_and_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(first, firstLower),
+				_mm_cmpeq_epi8(first, firstUpper)),
+			_mm_or_si128(_mm_cmpeq_epi8(last, lastLower),
+				_mm_cmpeq_epi8(last, lastUpper)));
+		uint32 mask = _mm_movemask_epi8(found);
+		while (mask != 0) {
+			int32 bit = lowest_bit(mask);
+			if (equals_no_case(text + i + bit, needle, needleLength))
+				return text + i + bit;
+			mask &= mask - 1;
+		}
+	}
+	return TextScan::FindNoCaseScalar(text + i, length - i, needle,
+		needleLength);
+}
+
+#endif	// SCAN_SSE2
+
+
+//	#pragma mark -
+
+
+/*static*/ const char*
+TextScan::FindAnyByte(const char* text, size_t length, const char* needles,
+	int32 count)
+{
+	if (count <= 0 || count > kMaxScanNeedles)
+		return NULL;
+	// the C library does a single byte well enough
+	if (count == 1)
+		return (const char*)memchr(text, needles[0], length);
+
+#ifdef SCAN_AVX2
+	if (kHasAVX2)
+		return find_any_byte_avx2(text, length, needles, count);
+#endif
+#ifdef SCAN_SSE2
+	return find_any_byte_sse2(text, length, needles, count);
+#else
+	return FindAnyByteScalar(text, length, needles, count);
+#endif
+}
+
+
+/*static*/ const char*
+TextScan::FindNoCase(const char* text, size_t length, const char* needle,
+	size_t needleLength)
+{
+	if (needleLength == 0)
+		return text;
+	if (needleLength > length)
+		return NULL;
+
+#ifdef SCAN_AVX2
+	if (kHasAVX2)
+		return find_no_case_avx2(text, length, needle, needleLength);
+#endif
+#ifdef SCAN_SSE2
+	return find_no_case_sse2(text, length, needle, needleLength);
+#else
+	return FindNoCaseScalar(text, length, needle, needleLength);
+#endif
+}
+
+
+/*static*/ const char*
+TextScan::FindAnyByteScalar(const char* text, size_t length,
+	const char* needles, int32 count)
+{
+	for (size_t i = 0; i < length; i++) {
+		for (int32 j = 0; j < count; j++) {
+			if (text[i] == needles[j])
+				return text + i;
+		}
+	}
+	return NULL;
+}
+
+
+/*static*/ const char*
+TextScan::FindNoCaseScalar(const char* text, size_t length,
+	const char* needle, size_t needleLength)
+{
+	if (needleLength == 0)
+		return text;
+
+	for (size_t i = 0; i + needleLength <= length; i++) {
+		size_t j = 0;
+		while (j < needleLength && fold_case(text[i + j]) == (uint8)needle[j])
+			j++;
+		if (j == needleLength)
+			return text + i;
+	}
+	return NULL;
+}
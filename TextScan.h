@@ -0,0 +1,39 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef TEXTSCAN_H
+#define TEXTSCAN_H
+
+#include <SupportDefs.h>
+
+static const int32 kMaxScanNeedles = 4;
+
+
+// Scanning of clip texts, 16 or 32 bytes at a time where the CPU can do
+// it (SSE2, AVX2), byte by byte otherwise. Only ASCII letters are matched
+// regardless of their case, all other bytes have to be the same.
+// Nothing here depends on the rest of Clipdinger, so it can be benchmarked
+// on its own.
+class TextScan {
+public:
+	// the first of up to kMaxScanNeedles bytes, NULL if there's none
+	static const char*	FindAnyByte(const char* text, size_t length,
+							const char* needles, int32 count);
+
+	// needle has to be in lower case already
+	static const char*	FindNoCase(const char* text, size_t length,
+							const char* needle, size_t needleLength);
+
+	// the plain byte by byte versions, for comparison
+	static const char*	FindAnyByteScalar(const char* text, size_t length,
+							const char* needles, int32 count);
+	static const char*	FindNoCaseScalar(const char* text, size_t length,
+							const char* needle, size_t needleLength);
+};
+
+#endif // TEXTSCAN_H
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <InterfaceDefs.h>
+
+#include "Constants.h"
+#include "TruncatedTitle.h"
+
+
+TruncatedTitle::TruncatedTitle()
+	:
+	fBucket(-1),
+	fFamilyAndStyle(0),
+	fSize(0)
+{
+}
+
+
+const BString&
+TruncatedTitle::Get(const BString& title, const BFont& font, float width)
+{
+	int32 bucket = width > 0 ? (int32)(width / kTitleWidthBucket) : 0;
+	if (bucket == fBucket && font.FamilyAndStyle() == fFamilyAndStyle
+		&& font.Size() == fSize)
+		return fTruncated;
+
+	// truncate to the start of the bucket, so it fits all of its widths
+	fTruncated = title;
+	font.TruncateString(&fTruncated, B_TRUNCATE_END,
+		bucket * kTitleWidthBucket);
+
+	fBucket = bucket;
+	fFamilyAndStyle = font.FamilyAndStyle();
+	fSize = font.Size();
+	return fTruncated;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef TRUNCATEDTITLE_H
+#define TRUNCATEDTITLE_H
+
+#include <Font.h>
+#include <String.h>
+
+
+// The title of a list item as it fits into its row. Truncating is only
+// done again when the font or the width changes by a whole bucket, so
+// drawing and resizing mostly get the cached string.
+class TruncatedTitle {
+public:
+						TruncatedTitle();
+
+	const BString&		Get(const BString& title, const BFont& font,
+							float width);
+	void				Invalidate() { fBucket = -1; };
+
+private:
+	BString				fTruncated;
+	int32				fBucket;
+	uint32				fFamilyAndStyle;
+	float				fSize;
+};
+
+#endif // TRUNCATEDTITLE_H
@@ -0,0 +1,578 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include <OS.h>
+#include <ScrollBar.h>
+#include <Window.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "VirtualListView.h"
+
+
+VirtualListView::VirtualListView(const char* name)
+	:
+	BView(name, B_WILL_DRAW | B_FRAME_EVENTS | B_NAVIGABLE
+		| B_FULL_UPDATE_ON_RESIZE),
+	fItemsModel(fItems),
+	fModel(&fItemsModel),
+	fSelected(-1),
+	fMultiple(false),
+	fRowHeight(1)
+{
+}
+
+
+VirtualListView::~VirtualListView()
+{
+	// like BListView, we don't own the items
+}
+
+
+void
+VirtualListView::AttachedToWindow()
+{
+	BView::AttachedToWindow();
+
+	// what BListItem::Update() would set for a single line of text
+	font_height fheight;
+	GetFontHeight(&fheight);
+	fRowHeight = ceilf(fheight.ascent + 2 + fheight.leading / 2
+		+ fheight.descent) + 5;
+
+	if (!Messenger().IsValid())
+		SetTarget(Window());
+
+	_UpdateScrollBar();
+}
+
+
+void
+VirtualListView::Draw(BRect updateRect)
+{
+	BRect bounds(Bounds());
+	int32 count = CountItems();
+	int32 first = std::max((int32)(updateRect.top / fRowHeight), (int32)0);
+	int32 last = std::min((int32)(updateRect.bottom / fRowHeight), count - 1);
+
+	for (int32 i = first; i <= last; i++)
+		ItemAt(i)->DrawItem(this, ItemFrame(i), true);
+
+	// the empty rest of the view
+	BRect rest(bounds);
+	rest.top = count * fRowHeight;
+	if (rest.IsValid() && rest.Intersects(updateRect)) {
+		SetHighColor(ui_color(B_CONTROL_BACKGROUND_COLOR));
+		FillRect(rest & updateRect);
+	}
+}
+
+
+void
+VirtualListView::FrameResized(float width, float height)
+{
+	// the rows fit their titles to the new width when they're drawn
+	BView::FrameResized(width, height);
+	_UpdateScrollBar();
+}
+
+
+void
+VirtualListView::KeyDown(const char* bytes, int32 numBytes)
+{
+	int32 page = std::max((int32)(Bounds().Height() / fRowHeight), (int32)1);
+	bool extend = fMultiple && (modifiers() & B_SHIFT_KEY) != 0;
+
+	switch (bytes[0]) {
+		case B_UP_ARROW:
+			_SelectAndShow(fSelected > 0 ? fSelected - 1 : 0, extend);
+			break;
+		case B_DOWN_ARROW:
+			_SelectAndShow(fSelected + 1, extend);
+			break;
+		case B_PAGE_UP:
+			_SelectAndShow(fSelected - page, extend);
+			break;
+		case B_PAGE_DOWN:
+			_SelectAndShow(fSelected + page, extend);
+			break;
+		case B_HOME:
+			_SelectAndShow(0, extend);
+			break;
+		case B_END:
+			_SelectAndShow(CountItems() - 1, extend);
+			break;
+		case B_RETURN:
+		case B_SPACE:
+			Invoke();
+			break;
+		default:
+			BView::KeyDown(bytes, numBytes);
+			break;
+	}
+}
+
+
+void
+VirtualListView::MouseDown(BPoint where)
+{
+	if (!IsFocus())
+		MakeFocus(true);
+
+	int32 index = IndexOf(where);
+	if (index < 0)
+		return;
+
+	int32 clicks = 1;
+	if (Window() != NULL && Window()->CurrentMessage() != NULL)
+		Window()->CurrentMessage()->FindInt32("clicks", &clicks);
+
+	int32 keys = modifiers();
+	if (fMultiple && (keys & B_SHIFT_KEY) != 0 && fSelected >= 0)
+		_SelectAndShow(index, true);
+	else if (fMultiple && (keys & B_COMMAND_KEY) != 0) {
+		if (fSelection.find(index) != fSelection.end())
+			Deselect(index);
+		else
+			Select(index, true);
+	} else if (clicks == 2 && index == fSelected)
+		Invoke();
+	else
+		Select(index);
+}
+
+
+void
+VirtualListView::MakeFocus(bool focus)
+{
+	if (focus == IsFocus())
+		return;
+
+	BView::MakeFocus(focus);
+
+	// the selection looks different with and without focus
+	_InvalidateSelection();
+}
+
+
+status_t
+VirtualListView::Invoke(BMessage* message)
+{
+	if (message == NULL)
+		message = Message();
+	if (message == NULL)
+		return B_BAD_VALUE;
+
+	BMessage clone(*message);
+	clone.AddInt64("when", system_time());
+	clone.AddPointer("source", this);
+	clone.AddInt32("index", fSelected);
+	return BInvoker::Invoke(&clone);
+}
+
+
+bool
+VirtualListView::AddItem(BListItem* item)
+{
+	return AddItem(item, fItems.CountItems());
+}
+
+
+bool
+VirtualListView::AddItem(BListItem* item, int32 index)
+{
+	if (!fItems.AddItem(item, index))
+		return false;
+
+	ItemsAdded(index, 1);
+	return true;
+}
+
+
+bool
+VirtualListView::AddList(BList* items)
+{
+	int32 index = fItems.CountItems();
+	if (!fItems.AddList(items))
+		return false;
+
+	ItemsAdded(index, items->CountItems());
+	return true;
+}
+
+
+BListItem*
+VirtualListView::RemoveItem(int32 index)
+{
+	BListItem* item = (BListItem*)fItems.ItemAt(index);
+	if (item == NULL || !RemoveItems(index, 1))
+		return NULL;
+	return item;
+}
+
+
+bool
+VirtualListView::RemoveItem(BListItem* item)
+{
+	return RemoveItem(fItems.IndexOf(item)) != NULL;
+}
+
+
+bool
+VirtualListView::RemoveItems(int32 index, int32 count)
+{
+	if (index < 0 || count <= 0 || index + count > fItems.CountItems())
+		return false;
+
+	// the items are still there to be told
+	std::set<int32>::iterator it = fSelection.lower_bound(index);
+	while (it != fSelection.end() && *it < index + count) {
+		ItemAt(*it)->Deselect();
+		fSelection.erase(it++);
+	}
+
+	fItems.RemoveItems(index, count);
+	ItemsRemoved(index, count);
+	return true;
+}
+
+
+void
+VirtualListView::MakeEmpty()
+{
+	DeselectAll();
+	fItems.MakeEmpty();
+	ScrollTo(0, 0);
+	Invalidate();
+	_UpdateScrollBar();
+}
+
+
+bool
+VirtualListView::MoveItem(int32 from, int32 to)
+{
+	if (!fItems.MoveItem(from, to))
+		return false;
+
+	ItemMoved(from, to);
+	return true;
+}
+
+
+bool
+VirtualListView::SwapItems(int32 a, int32 b)
+{
+	if (!fItems.SwapItems(a, b))
+		return false;
+
+	if (fSelected == a)
+		fSelected = b;
+	else if (fSelected == b)
+		fSelected = a;
+
+	bool aSelected = fSelection.erase(a) > 0;
+	if (fSelection.erase(b) > 0)
+		fSelection.insert(a);
+	if (aSelected)
+		fSelection.insert(b);
+
+	InvalidateItem(a);
+	InvalidateItem(b);
+	return true;
+}
+
+
+void
+VirtualListView::SetModel(ListModel* model)
+{
+	if (model == NULL)
+		model = &fItemsModel;
+	if (model == fModel)
+		return;
+
+	DeselectAll();
+	fModel = model;
+	ScrollTo(0, 0);
+	Invalidate();
+	_UpdateScrollBar();
+}
+
+
+void
+VirtualListView::ItemsAdded(int32 index, int32 count)
+{
+	std::set<int32> selection;
+	for (std::set<int32>::iterator it = fSelection.begin();
+			it != fSelection.end(); it++)
+		selection.insert(*it >= index ? *it + count : *it);
+	fSelection.swap(selection);
+
+	if (fSelected >= index)
+		fSelected += count;
+	_InvalidateFrom(index);
+	_UpdateScrollBar();
+}
+
+
+void
+VirtualListView::ItemsRemoved(int32 index, int32 count)
+{
+	std::set<int32> selection;
+	for (std::set<int32>::iterator it = fSelection.begin();
+			it != fSelection.end(); it++) {
+		if (*it >= index + count)
+			selection.insert(*it - count);
+		else if (*it < index)
+			selection.insert(*it);
+	}
+	fSelection.swap(selection);
+
+	if (fSelected >= index + count)
+		fSelected -= count;
+	else if (fSelected >= index)
+		fSelected = fSelection.empty() ? -1 : *fSelection.begin();
+	_InvalidateFrom(index);
+	_UpdateScrollBar();
+}
+
+
+static int32
+moved_index(int32 index, int32 from, int32 to)
+{
+	if (index == from)
+		return to;
+	if (from < index && index <= to)
+		return index - 1;
+	if (to <= index && index < from)
+		return index + 1;
+	return index;
+}
+
+
+void
+VirtualListView::ItemMoved(int32 from, int32 to)
+{
+	std::set<int32> selection;
+	for (std::set<int32>::iterator it = fSelection.begin();
+			it != fSelection.end(); it++)
+		selection.insert(moved_index(*it, from, to));
+	fSelection.swap(selection);
+
+	if (fSelected >= 0)
+		fSelected = moved_index(fSelected, from, to);
+
+	// everything in between has moved by one row
+	Invalidate(ItemFrame(std::min(from, to))
+		| ItemFrame(std::max(from, to)));
+}
+
+
+int32
+VirtualListView::IndexOf(BListItem* item) const
+{
+	if (fModel == &fItemsModel)
+		return fItems.IndexOf(item);
+
+	for (int32 i = 0; i < CountItems(); i++) {
+		if (ItemAt(i) == item)
+			return i;
+	}
+	return -1;
+}
+
+
+int32
+VirtualListView::IndexOf(BPoint point) const
+{
+	if (point.y < 0)
+		return -1;
+
+	int32 index = (int32)(point.y / fRowHeight);
+	return index < CountItems() ? index : -1;
+}
+
+
+void
+VirtualListView::SetMultipleSelection(bool multiple)
+{
+	fMultiple = multiple;
+	if (!multiple && fSelection.size() > 1) {
+		int32 index = fSelected;
+		DeselectAll();
+		Select(index);
+	}
+}
+
+
+void
+VirtualListView::Select(int32 index, bool extend)
+{
+	BListItem* item = ItemAt(index);
+	if (item == NULL)
+		return;
+
+	if (!extend || !fMultiple) {
+		if (index == fSelected && fSelection.size() == 1)
+			return;
+		DeselectAll();
+	}
+
+	item->Select();
+	fSelection.insert(index);
+	fSelected = index;
+	InvalidateItem(index);
+}
+
+
+void
+VirtualListView::Deselect(int32 index)
+{
+	if (fSelection.erase(index) == 0)
+		return;
+
+	ItemAt(index)->Deselect();
+	InvalidateItem(index);
+	if (index == fSelected)
+		fSelected = fSelection.empty() ? -1 : *fSelection.rbegin();
+}
+
+
+void
+VirtualListView::DeselectAll()
+{
+	for (std::set<int32>::iterator it = fSelection.begin();
+			it != fSelection.end(); it++) {
+		ItemAt(*it)->Deselect();
+		InvalidateItem(*it);
+	}
+	fSelection.clear();
+	fSelected = -1;
+}
+
+
+int32
+VirtualListView::SelectedAt(int32 index) const
+{
+	if (index < 0 || index >= (int32)fSelection.size())
+		return -1;
+
+	std::set<int32>::const_iterator it = fSelection.begin();
+	std::advance(it, index);
+	return *it;
+}
+
+
+void
+VirtualListView::ScrollToSelection()
+{
+	if (fSelected < 0)
+		return;
+
+	BRect frame(ItemFrame(fSelected));
+	BRect bounds(Bounds());
+	if (frame.top < bounds.top)
+		ScrollTo(0, frame.top);
+	else if (frame.bottom > bounds.bottom)
+		ScrollTo(0, frame.bottom - bounds.Height());
+}
+
+
+BRect
+VirtualListView::ItemFrame(int32 index) const
+{
+	return BRect(0, index * fRowHeight, Bounds().right,
+		(index + 1) * fRowHeight - 1);
+}
+
+
+void
+VirtualListView::InvalidateItem(int32 index)
+{
+	if (index >= 0 && index < CountItems())
+		Invalidate(ItemFrame(index));
+}
+
+
+void
+VirtualListView::InvalidateItems(const BList& items)
+{
+	if (items.IsEmpty())
+		return;
+
+	// rows outside the view will look right once they're scrolled to
+	std::set<BListItem*> changed((BListItem**)items.Items(),
+		(BListItem**)items.Items() + items.CountItems());
+	BRect bounds(Bounds());
+	int32 first = std::max((int32)(bounds.top / fRowHeight), (int32)0);
+	int32 last = std::min((int32)(bounds.bottom / fRowHeight),
+		CountItems() - 1);
+	for (int32 i = first; i <= last; i++) {
+		if (changed.find(ItemAt(i)) != changed.end())
+			InvalidateItem(i);
+	}
+}
+
+
+void
+VirtualListView::_InvalidateFrom(int32 index)
+{
+	// everything from here on has moved
+	BRect frame(Bounds());
+	frame.top = std::max(frame.top, index * fRowHeight);
+	if (frame.IsValid())
+		Invalidate(frame);
+}
+
+
+void
+VirtualListView::_UpdateScrollBar()
+{
+	BScrollBar* scrollBar = ScrollBar(B_VERTICAL);
+	if (scrollBar == NULL)
+		return;
+
+	float height = Bounds().Height();
+	float total = CountItems() * fRowHeight;
+	scrollBar->SetRange(0, std::max(total - height, 0.0f));
+	scrollBar->SetProportion(total > 0 ? std::min(height / total, 1.0f) : 1);
+	scrollBar->SetSteps(fRowHeight, std::max(height - fRowHeight,
+		fRowHeight));
+}
+
+
+void
+VirtualListView::_SelectAndShow(int32 index, bool extend)
+{
+	int32 count = CountItems();
+	if (count == 0)
+		return;
+
+	index = std::max(std::min(index, count - 1), (int32)0);
+	if (extend && fSelected >= 0) {
+		// everything from the last selected row on
+		int32 step = index < fSelected ? -1 : 1;
+		for (int32 i = fSelected; i != index; i += step)
+			Select(i, true);
+		Select(index, true);
+	} else
+		Select(index);
+	ScrollToSelection();
+}
+
+
+void
+VirtualListView::_InvalidateSelection()
+{
+	for (std::set<int32>::iterator it = fSelection.begin();
+			it != fSelection.end(); it++)
+		InvalidateItem(*it);
+}
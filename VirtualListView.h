@@ -0,0 +1,105 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef VIRTUALLISTVIEW_H
+#define VIRTUALLISTVIEW_H
+
+#include <Invoker.h>
+#include <List.h>
+#include <ListItem.h>
+#include <View.h>
+
+#include <set>
+
+#include "ListModel.h"
+
+// A list view, much like BListView, whose rows all have the same height.
+// Finding the frame of a row, or the row at a point, is a simple
+// calculation, and adding items doesn't touch them at all.
+// Only the rows that are actually visible are drawn, it's up to the items
+// to fit themselves to the width of their frame when they are.
+// The view either keeps a list of items itself, or shows a ListModel it's
+// given with SetModel(). Whoever changes that model has to report what
+// changed with ItemsAdded() and friends, the other methods that add or
+// remove items only work on the view's own list.
+// With multiple selection, shift extends the selection and command
+// toggles rows, CurrentSelection() is the row that was selected last.
+class VirtualListView : public BView, public BInvoker {
+public:
+					VirtualListView(const char* name);
+	virtual			~VirtualListView();
+
+	virtual void	AttachedToWindow();
+	virtual void	Draw(BRect updateRect);
+	virtual	void	FrameResized(float width, float height);
+	virtual	void	KeyDown(const char* bytes, int32 numBytes);
+	virtual	void	MouseDown(BPoint where);
+	virtual	void	MakeFocus(bool focus = true);
+	virtual	status_t Invoke(BMessage* message = NULL);
+
+	bool			AddItem(BListItem* item);
+	bool			AddItem(BListItem* item, int32 index);
+	bool			AddList(BList* items);
+	BListItem*		RemoveItem(int32 index);
+	bool			RemoveItem(BListItem* item);
+	bool			RemoveItems(int32 index, int32 count);
+	void			MakeEmpty();
+	bool			MoveItem(int32 from, int32 to);
+	bool			SwapItems(int32 a, int32 b);
+
+	// NULL goes back to the view's own list
+	void			SetModel(ListModel* model);
+	ListModel*		Model() const { return fModel; };
+	void			ItemsAdded(int32 index, int32 count);
+	// the removed items may already be deleted
+	void			ItemsRemoved(int32 index, int32 count);
+	void			ItemMoved(int32 from, int32 to);
+
+	BListItem*		ItemAt(int32 index) const
+						{ return fModel->ItemAt(index); };
+	int32			IndexOf(BListItem* item) const;
+	int32			IndexOf(BPoint point) const;
+	int32			CountItems() const { return fModel->CountItems(); };
+	bool			IsEmpty() const { return fModel->IsEmpty(); };
+
+	void			SetMultipleSelection(bool multiple);
+	void			Select(int32 index, bool extend = false);
+	void			Deselect(int32 index);
+	void			DeselectAll();
+	int32			CurrentSelection() const { return fSelected; };
+	// the selected rows from top to bottom
+	int32			CountSelected() const { return fSelection.size(); };
+	bool			IsItemSelected(int32 index) const
+						{ return fSelection.count(index) > 0; };
+	int32			SelectedAt(int32 index) const;
+	void			ScrollToSelection();
+
+	float			RowHeight() const { return fRowHeight; };
+	BRect			ItemFrame(int32 index) const;
+	void			InvalidateItem(int32 index);
+	void			InvalidateItems(const BList& items);
+
+	void			SetInvocationMessage(BMessage* message)
+						{ SetMessage(message); };
+
+private:
+	void			_InvalidateFrom(int32 index);
+	void			_UpdateScrollBar();
+	void			_SelectAndShow(int32 index, bool extend = false);
+	void			_InvalidateSelection();
+
+	BList			fItems;
+	PlainListModel	fItemsModel;
+	ListModel*		fModel;
+	int32			fSelected;
+	std::set<int32>	fSelection;
+	bool			fMultiple;
+	float			fRowHeight;
+};
+
+#endif // VIRTUALLISTVIEW_H
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Checks that a clip's text is copied once on its way from the clipboard
+// to the store and back to the clipboard: into the ClipData when it's
+// interned, and into the clipboard message when it's pasted. Looking it
+// up again and reading it for the paste share that one buffer.
+// The history item in between is the benchmarks' stand-in for ClipItem,
+// the test doesn't vouch for the real one.
+// Allocations are counted by wrapping the C library's allocator, which
+// operator new uses as well. That needs glibc.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include <Message.h>
+
+#include "ClipItem.h"
+#include "ClipStore.h"
+
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void __libc_free(void* pointer);
+
+static bool sCounting = false;
+static size_t sTextSize = 0;
+static int32 sAllocations = 0;
+// allocations that are large enough to hold a copy of the text
+static int32 sTextCopies = 0;
+
+
+static void
+count_allocation(size_t size)
+{
+	if (!sCounting)
+		return;
+
+	sAllocations++;
+	if (size >= sTextSize)
+		sTextCopies++;
+}
+
+
+extern "C" void*
+malloc(size_t size)
+{
+	count_allocation(size);
+	return __libc_malloc(size);
+}
+
+
+extern "C" void*
+calloc(size_t count, size_t size)
+{
+	count_allocation(count * size);
+	return __libc_calloc(count, size);
+}
+
+
+extern "C" void*
+realloc(void* pointer, size_t size)
+{
+	count_allocation(size);
+	return __libc_realloc(pointer, size);
+}
+
+
+extern "C" void
+free(void* pointer)
+{
+	__libc_free(pointer);
+}
+
+
+static void
+start_counting(size_t textSize)
+{
+	sTextSize = textSize;
+	sAllocations = 0;
+	sTextCopies = 0;
+	sCounting = true;
+}
+
+
+static void
+stop_counting()
+{
+	sCounting = false;
+}
+
+
+static int32 sFailures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, \
+				#condition); \
+			sFailures++; \
+		} \
+	} while (false)
+
+
+static std::string
+make_text(size_t size)
+{
+	// below the compression threshold, so the clip keeps it as it is
+	std::string text;
+	for (size_t i = 0; text.size() < size; i++) {
+		char word[32];
+		snprintf(word, sizeof(word), "word%u ", (unsigned)(i * 7919 % 10007));
+		text.append(word);
+	}
+	text.resize(size);
+	return text;
+}
+
+
+static void
+test_round_trip()
+{
+	std::string text = make_text(8000);
+	BMessage clipboard;
+	clipboard.AddData("text/plain", B_MIME_TYPE, text.data(), text.size());
+	ClipStore store;
+
+	// what ClipIngest does with a clipboard change
+	start_counting(text.size());
+	const char* data = NULL;
+	ssize_t size = 0;
+	CHECK(clipboard.FindData("text/plain", B_MIME_TYPE,
+		(const void**)&data, &size) == B_OK);
+	ClipData* clip = store.Intern(data, size);
+	stop_counting();
+	CHECK(clip != NULL);
+	CHECK(sTextCopies == 1);
+
+	// the same text again only finds the clip that's already there
+	start_counting(text.size());
+	ClipData* again = store.Intern(data, size);
+	stop_counting();
+	CHECK(again == clip);
+	CHECK(sTextCopies == 0);
+	again->ReleaseReference();
+
+	BString title;
+	clip->GetTitle(title);
+	ClipItem* item = new ClipItem(clip, title, "/boot/system/apps/Pe", 0);
+	clip->ReleaseReference();
+
+	// pasting hands out the stored text itself
+	start_counting(text.size());
+	BString buffer;
+	size_t length;
+	const char* pasted = item->GetClipData()->GetText(buffer, length);
+	stop_counting();
+	CHECK(sAllocations == 0);
+	CHECK(length == text.size() && memcmp(pasted, text.data(), length) == 0);
+
+	// and the clipboard takes its own copy, as it always does
+	start_counting(text.size());
+	BMessage paste;
+	paste.AddData("text/plain", B_MIME_TYPE, pasted, length);
+	stop_counting();
+	CHECK(sTextCopies == 1);
+
+	delete item;
+}
+
+
+int
+main()
+{
+	test_round_trip();
+
+	if (sFailures > 0) {
+		fprintf(stderr, "%d checks failed\n", (int)sFailures);
+		return EXIT_FAILURE;
+	}
+	printf("clip buffers: all checks passed\n");
+	return EXIT_SUCCESS;
+}
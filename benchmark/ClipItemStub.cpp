@@ -0,0 +1,49 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#include "ClipItem.h"
+
+
+// The parts of ClipItem the engine uses, without drawing and icons.
+
+ClipItem::ClipItem(ClipData* clip, const BString& title, const BString& path,
+	int32 time)
+{
+	fClip = clip;
+	fClip->AcquireReference();
+	ClipData::MakeTitle(title.String(), title.Length(), fClipTitle);
+	fOrigin = path;
+	fTimeAdded = time;
+	fPasteCount = 0;
+	fColor = ui_color(B_LIST_BACKGROUND_COLOR);
+	fFadeDeadline = 0;
+	fOriginIcon = NULL;
+}
+
+
+ClipItem::~ClipItem()
+{
+	fClip->ReleaseReference();
+}
+
+
+bool
+ClipItem::SetColor(rgb_color color)
+{
+	if (color == fColor)
+		return false;
+
+	fColor = color;
+	return true;
+}
+
+
+void
+ClipItem::DrawItem(BView* view, BRect rect, bool complete)
+{
+}
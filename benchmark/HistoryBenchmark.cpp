@@ -0,0 +1,574 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Drives the history engine through synthetic workloads, the way the
+// window does: clipboard changes with duplicates among them, saving and
+// loading histories of different sizes, journaling changes and compacting
+// the journal, cropping the history when its limit is lowered, evicting
+// clips over the memory limit, pasting clips again, fading, and typing
+// into the filter.
+// Latencies are given as
+// percentiles over many runs, together with the peak memory use of the
+// process so far.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <Directory.h>
+#include <OS.h>
+
+#include "ClipFilter.h"
+#include "ClipHistory.h"
+#include "ClipItem.h"
+#include "ClipStore.h"
+#include "Constants.h"
+#include "FadeSchedule.h"
+#include "HistoryFile.h"
+#include "HistoryJournal.h"
+
+
+static const int32 kChanges = 20000;
+static const int32 kHistoryLimit = 1000;
+static const int32 kIORuns = 5;
+static const int32 kCropRuns = 20;
+static const int32 kFadeRuns = 20;
+static const int32 kPasteRuns = 10000;
+static const int32 kFilterRuns = 5;
+
+static const char* kWords[] = {
+	"the", "of", "and", "clipboard", "Haiku", "window", "return", "const",
+	"char", "status_t", "BString", "http://", "www.", ".com/", "int32",
+	"if", "else", "for", "while", "Tracker", "Deskbar", "error:", "warning",
+	"Humdinger", "paste", "copy", "void", "{", "}", "(", ")", ";", "=",
+	"\xc3\xa9t\xc3\xa9", "\xe2\x80\xa6"
+};
+static const int32 kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+
+static uint32 sSeed = 0x2015;
+
+static uint32
+random_number()
+{
+	// xorshift, the same workload every time
+	sSeed ^= sSeed << 13;
+	sSeed ^= sSeed >> 17;
+	sSeed ^= sSeed << 5;
+	return sSeed;
+}
+
+
+static size_t
+random_size()
+{
+	// mostly words and lines, now and then something big
+	uint32 kind = random_number() % 1000;
+	if (kind < 600)
+		return 8 + random_number() % 112;
+	if (kind < 900)
+		return 120 + random_number() % 4000;
+	if (kind < 995)
+		return 4096 + random_number() % 61440;
+	return 65536 + random_number() % 983040;
+}
+
+
+static std::string
+make_clip(size_t size)
+{
+	std::string clip;
+	char serial[16];
+	snprintf(serial, sizeof(serial), "%08x ", (unsigned)random_number());
+	clip += serial;
+	while (clip.size() < size) {
+		clip += kWords[random_number() % kWordCount];
+		clip += random_number() % 16 == 0 ? '\n' : ' ';
+	}
+	clip.resize(size);
+	return clip;
+}
+
+
+static long
+peak_memory()
+{
+	// in KiB
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+
+static void
+print_latencies(const char* name, std::vector<bigtime_t>& latencies)
+{
+	std::sort(latencies.begin(), latencies.end());
+	size_t count = latencies.size();
+	printf("%-28s %9lld %9lld %9lld %9lld %10ld\n", name,
+		(long long)latencies[count / 2],
+		(long long)latencies[count * 90 / 100],
+		(long long)latencies[std::min(count * 99 / 100, count - 1)],
+		(long long)latencies[count - 1], peak_memory());
+}
+
+
+// What the window keeps, without the journal and the views: the clips in
+// order, newest first, an older copy of a new clip making room for it.
+struct history_model {
+	ClipStore						store;
+	ClipHistory						items;
+
+	history_model()
+		:
+		items(&store)
+	{
+	}
+
+	void Add(const std::string& text, int32 time)
+	{
+		ClipData* clip = store.Intern(text.data(), text.size());
+		if (clip == NULL)
+			return;
+
+		int32 index = items.IndexOf(clip);
+		if (index >= 0)
+			items.RemoveItems(index, 1);
+
+		BString title;
+		clip->GetTitle(title);
+		ClipItem* item = new ClipItem(clip, title, "/boot/system/apps/Pe",
+			time);
+		clip->ReleaseReference();
+		items.AddFirst(item);
+	}
+
+	void RemoveFrom(int32 index)
+	{
+		if (index < items.CountItems())
+			items.RemoveItems(index, items.CountItems() - index);
+	}
+};
+
+
+static void
+fill(history_model& model, int32 count, const std::vector<std::string>& pool)
+{
+	// the texts of the pool start with a serial number, so they can be
+	// made distinct again when the history is larger than the pool
+	int32 now = real_time_clock();
+	for (int32 i = 0; i < count; i++) {
+		std::string text = pool[i % pool.size()];
+		char serial[16];
+		snprintf(serial, sizeof(serial), "%08x", (unsigned)i);
+		text.replace(0, 8, serial);
+		model.Add(text, now - (count - i) * 60);
+	}
+}
+
+
+static std::vector<std::string>
+make_pool(int32 count, size_t maxSize)
+{
+	std::vector<std::string> pool;
+	for (int32 i = 0; i < count; i++)
+		pool.push_back(make_clip(std::min(random_size(), maxSize)));
+	return pool;
+}
+
+
+static void
+benchmark_ingest(double dedupRatio)
+{
+	// a change either brings back an earlier text, or a new one
+	std::vector<std::string> seen;
+	history_model model;
+	std::vector<bigtime_t> latencies;
+	int32 now = real_time_clock();
+	for (int32 i = 0; i < kChanges; i++) {
+		std::string text;
+		if (!seen.empty() && random_number() % 1000 < dedupRatio * 1000)
+			text = seen[random_number() % seen.size()];
+		else {
+			text = make_clip(random_size());
+			seen.push_back(text);
+			if (seen.size() > (size_t)kHistoryLimit)
+				seen.erase(seen.begin());
+		}
+
+		bigtime_t start = system_time();
+		model.Add(text, now + i);
+		model.RemoveFrom(kHistoryLimit);
+		latencies.push_back(system_time() - start);
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "ingest, %d%% duplicates",
+		(int)(dedupRatio * 100));
+	print_latencies(name, latencies);
+}
+
+
+static void
+to_entries(const ClipHistory& items, BList& entries)
+{
+	for (int32 i = 0; i < items.CountItems(); i++) {
+		ClipItem* item = items.ClipAt(i);
+		history_entry* entry = new history_entry;
+		entry->clip = item->GetClipData();
+		entry->clip->AcquireReference();
+		entry->title = item->GetClipTitle();
+		entry->origin = item->GetOrigin();
+		entry->time = item->GetTimeAdded();
+		entry->pasteCount = item->GetPasteCount();
+		entries.AddItem(entry);
+	}
+}
+
+
+static void
+benchmark_save_load(const char* directory, int32 count,
+	const std::vector<std::string>& pool)
+{
+	history_model model;
+	fill(model, count, pool);
+
+	BString path(directory);
+	path.Append("/history");
+
+	BList history;
+	BList favorites;
+	to_entries(model.items, history);
+
+	std::vector<bigtime_t> saves;
+	std::vector<bigtime_t> loads;
+	for (int32 run = 0; run < kIORuns; run++) {
+		bigtime_t start = system_time();
+		status_t status = HistoryFile::Write(path.String(), &history,
+			&favorites, run, real_time_clock());
+		saves.push_back(system_time() - start);
+		if (status != B_OK) {
+			fprintf(stderr, "saving failed: %d\n", (int)status);
+			exit(EXIT_FAILURE);
+		}
+
+		// into a store of its own, like right after launch
+		ClipStore store;
+		start = system_time();
+		HistoryFile* file = new HistoryFile;
+		BList loaded;
+		BList loadedFavorites;
+		status = file->SetTo(path.String());
+		if (status == B_OK)
+			status = file->GetEntries(&store, &loaded, &loadedFavorites);
+		loads.push_back(system_time() - start);
+		if (status != B_OK || loaded.CountItems() != count) {
+			fprintf(stderr, "loading failed: %d, %d of %d entries\n",
+				(int)status, (int)loaded.CountItems(), (int)count);
+			exit(EXIT_FAILURE);
+		}
+		HistoryFile::EmptyEntries(&loaded);
+		HistoryFile::EmptyEntries(&loadedFavorites);
+		file->ReleaseReference();
+	}
+	HistoryFile::EmptyEntries(&history);
+	unlink(path.String());
+
+	char name[64];
+	snprintf(name, sizeof(name), "save %d entries", (int)count);
+	print_latencies(name, saves);
+	snprintf(name, sizeof(name), "load %d entries", (int)count);
+	print_latencies(name, loads);
+}
+
+
+static void
+benchmark_journal(const char* directory, const std::vector<std::string>& pool)
+{
+	// the records are synced by the journal's own thread, an append only
+	// writes them
+	std::vector<bigtime_t> appends;
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		for (int32 i = 0; i < kJournalCompactRecords; i++) {
+			const std::string& text = pool[i % pool.size()];
+			ClipData* clip = store.Intern(text.data(), text.size());
+			bigtime_t start = system_time();
+			if (i % 4 == 3)
+				journal.MoveClipToTop(i / 2, real_time_clock());
+			else
+				journal.AddClip(clip, "/boot/system/apps/Pe",
+					real_time_clock());
+			appends.push_back(system_time() - start);
+			clip->ReleaseReference();
+		}
+	}
+
+	// a journal that's due for compaction, as after a crash
+	std::vector<bigtime_t> replays;
+	for (int32 run = 0; run < kIORuns; run++) {
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		bigtime_t start = system_time();
+		journal.Load(&store, &history, &favorites, &quitTime);
+		replays.push_back(system_time() - start);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+	}
+
+	std::vector<bigtime_t> compactions;
+	history_model model;
+	fill(model, 10000, pool);
+	for (int32 run = 0; run < kIORuns; run++) {
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+
+		BList* entries = new BList;
+		to_entries(model.items, *entries);
+		bigtime_t start = system_time();
+		journal.Compact(entries, new BList, real_time_clock(), true);
+		compactions.push_back(system_time() - start);
+	}
+
+	BDirectory dir(directory);
+	BEntry entry;
+	while (dir.GetNextEntry(&entry) == B_OK)
+		entry.Remove();
+
+	print_latencies("journal append", appends);
+	char name[64];
+	snprintf(name, sizeof(name), "journal replay %d records",
+		(int)kJournalCompactRecords);
+	print_latencies(name, replays);
+	print_latencies("journal compaction 10000", compactions);
+}
+
+
+static void
+benchmark_crop(int32 count, int32 limit, const std::vector<std::string>& pool)
+{
+	std::vector<bigtime_t> latencies;
+	for (int32 run = 0; run < kCropRuns; run++) {
+		history_model model;
+		fill(model, count, pool);
+
+		bigtime_t start = system_time();
+		model.RemoveFrom(limit);
+		latencies.push_back(system_time() - start);
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "crop %d to %d", (int)count, (int)limit);
+	print_latencies(name, latencies);
+}
+
+
+static void
+benchmark_evict(int32 count, const std::vector<std::string>& pool)
+{
+	history_model model;
+	model.items.SetEvictionPolicy(EvictionPolicy::Create(kEvictLargest));
+	fill(model, count, pool);
+	for (int32 i = 0; i < count; i += 10)
+		model.items.AddFavorite(model.items.ClipAt(i)->GetClipData());
+
+	// down to half the memory, one clip at a time, as the window does
+	std::vector<bigtime_t> latencies;
+	off_t limit = model.items.Bytes() / 2;
+	while (model.items.Bytes() > limit) {
+		bigtime_t start = system_time();
+		int32 victim = model.items.NextEviction();
+		if (victim < 0)
+			break;
+		model.items.RemoveItems(victim, 1);
+		latencies.push_back(system_time() - start);
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "evict %d to half", (int)count);
+	print_latencies(name, latencies);
+}
+
+
+static void
+benchmark_paste(int32 count, const std::vector<std::string>& pool)
+{
+	history_model model;
+	fill(model, count, pool);
+
+	// a pasted clip comes back to the front, mostly it's a recent one
+	std::vector<bigtime_t> latencies;
+	int32 now = real_time_clock();
+	for (int32 run = 0; run < kPasteRuns; run++) {
+		int32 index = random_number() % 5 != 0 ? random_number() % 20
+			: random_number() % count;
+		ClipData* clip = model.items.ClipAt(index)->GetClipData();
+
+		bigtime_t start = system_time();
+		model.items.MoveToFirst(model.items.IndexOf(clip), now + run);
+		latencies.push_back(system_time() - start);
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "paste again %d", (int)count);
+	print_latencies(name, latencies);
+}
+
+
+static void
+benchmark_fade(int32 count, const std::vector<std::string>& pool)
+{
+	history_model model;
+	fill(model, count, pool);
+
+	// every settings change starts all clips over
+	FadeSchedule fades;
+	std::vector<bigtime_t> recomputes;
+	int32 now = real_time_clock();
+	for (int32 run = 0; run < kFadeRuns; run++) {
+		fades.SetSettings(true, 10 + run % 2, 5, 1.2);
+		bigtime_t start = system_time();
+		for (int32 i = 0; i < model.items.CountItems(); i++)
+			fades.Add(model.items.ClipAt(i), now);
+		recomputes.push_back(system_time() - start);
+	}
+
+	// then the ticks, each one step later
+	std::vector<bigtime_t> ticks;
+	for (int32 run = 0; run < kFadeRuns; run++) {
+		BList changed;
+		bigtime_t start = system_time();
+		fades.Advance(now + (run + 1) * 600, changed);
+		ticks.push_back(system_time() - start);
+	}
+	fades.MakeEmpty();
+
+	char name[64];
+	snprintf(name, sizeof(name), "fade recompute %d", (int)count);
+	print_latencies(name, recomputes);
+	snprintf(name, sizeof(name), "fade tick %d", (int)count);
+	print_latencies(name, ticks);
+}
+
+
+static const char*
+clip_item_text(BListItem* item, BString& buffer, size_t& length)
+{
+	// as the window does it, packed clips only match by their title
+	ClipData* clip = ((ClipItem*)item)->GetClipData();
+	if (clip->IsCompressed() || clip->IsSpilled()) {
+		clip->GetTitle(buffer);
+		length = buffer.Length();
+		return buffer.String();
+	}
+	return clip->GetText(buffer, length);
+}
+
+
+static void
+benchmark_filter(int32 count, const std::vector<std::string>& pool)
+{
+	history_model model;
+	fill(model, count, pool);
+
+	// typed one character at a time: the first one looks at every clip,
+	// the others only at what matched before
+	static const char* kQueries[] = {
+		"clipboard", "Status_t ret", "hmdngr", "www.haiku", "qqq"
+	};
+	static const int32 kQueryCount = sizeof(kQueries) / sizeof(kQueries[0]);
+
+	ClipFilter filter(clip_item_text);
+	BList results(kMaxFilterResults);
+	std::vector<bigtime_t> firsts;
+	std::vector<bigtime_t> keys;
+	for (int32 run = 0; run < kFilterRuns; run++) {
+		for (int32 i = 0; i < kQueryCount; i++) {
+			filter.Reset();
+			std::string query;
+			for (const char* c = kQueries[i]; *c != '\0'; c++) {
+				query += *c;
+				bigtime_t start = system_time();
+				filter.Filter(query.c_str(), model.items, results,
+					kMaxFilterResults);
+				bigtime_t latency = system_time() - start;
+				if (query.size() == 1)
+					firsts.push_back(latency);
+				else
+					keys.push_back(latency);
+			}
+		}
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "filter %d, first key", (int)count);
+	print_latencies(name, firsts);
+	snprintf(name, sizeof(name), "filter %d, next keys", (int)count);
+	print_latencies(name, keys);
+}
+
+
+int
+main()
+{
+	char directory[] = "/tmp/clipdinger_benchmark_XXXXXX";
+	if (mkdtemp(directory) == NULL) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+
+	printf("%-28s %9s %9s %9s %9s %10s\n", "workload (microseconds)", "p50",
+		"p90", "p99", "max", "peak KiB");
+
+	benchmark_ingest(0.0);
+	benchmark_ingest(0.5);
+	benchmark_ingest(0.9);
+
+	// without the rare huge clips, or the 100k history wouldn't fit
+	std::vector<std::string> pool = make_pool(10000, 4096);
+	benchmark_save_load(directory, 1000, pool);
+	benchmark_save_load(directory, 10000, pool);
+	benchmark_save_load(directory, 100000, pool);
+
+	benchmark_journal(directory, pool);
+	benchmark_crop(10000, 100, pool);
+	benchmark_evict(10000, pool);
+	benchmark_evict(100000, pool);
+	benchmark_paste(10000, pool);
+	benchmark_paste(100000, pool);
+	benchmark_fade(10000, pool);
+	benchmark_fade(100000, pool);
+
+	// the whole mix of sizes, the full texts are what's filtered
+	std::vector<std::string> clips = make_pool(1000, (size_t)-1);
+	benchmark_filter(1000, clips);
+	benchmark_filter(10000, clips);
+
+	rmdir(directory);
+	return EXIT_SUCCESS;
+}
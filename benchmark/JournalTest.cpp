@@ -0,0 +1,342 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Checks that what the history journal replays is what was recorded:
+// clips added, removed, moved to the top and cleared, across compactions,
+// and that a torn or corrupt end of the journal only loses that end.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include <Directory.h>
+#include <File.h>
+#include <OS.h>
+
+#include "ClipStore.h"
+#include "Constants.h"
+#include "HistoryFile.h"
+#include "HistoryJournal.h"
+
+
+static int32 sFailures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, \
+				#condition); \
+			sFailures++; \
+		} \
+	} while (false)
+
+
+// the history as the journal should have it, newest first
+typedef std::vector<std::string> history_texts;
+
+
+static void
+load(const char* directory, history_texts& texts,
+	std::vector<int32>* pasteCounts = NULL)
+{
+	ClipStore store;
+	HistoryJournal journal(directory);
+	BList history;
+	BList favorites;
+	int32 quitTime;
+	CHECK(journal.Load(&store, &history, &favorites, &quitTime) == B_OK);
+
+	texts.clear();
+	for (int32 i = 0; i < history.CountItems(); i++) {
+		history_entry* entry = (history_entry*)history.ItemAt(i);
+		BString text = entry->clip->Text();
+		texts.push_back(std::string(text.String(), text.Length()));
+		if (pasteCounts != NULL)
+			pasteCounts->push_back(entry->pasteCount);
+	}
+	HistoryFile::EmptyEntries(&history);
+	HistoryFile::EmptyEntries(&favorites);
+}
+
+
+static void
+add(HistoryJournal& journal, ClipStore& store, const char* text)
+{
+	ClipData* clip = store.Intern(text, strlen(text));
+	journal.AddClip(clip, "/boot/system/apps/Pe", real_time_clock());
+	clip->ReleaseReference();
+}
+
+
+static BList*
+to_entries(ClipStore& store, const history_texts& texts)
+{
+	BList* entries = new BList;
+	for (size_t i = 0; i < texts.size(); i++) {
+		history_entry* entry = new history_entry;
+		entry->clip = store.Intern(texts[i].data(), texts[i].size());
+		entry->time = real_time_clock();
+		entries->AddItem(entry);
+	}
+	return entries;
+}
+
+
+static void
+append_raw(const char* path, const void* data, size_t size)
+{
+	BFile file(path, B_WRITE_ONLY | B_OPEN_AT_END);
+	CHECK(file.Write(data, size) == (ssize_t)size);
+}
+
+
+static void
+test_replay(const char* directory)
+{
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		CHECK(journal.Load(&store, &history, &favorites, &quitTime) == B_OK);
+		CHECK(history.IsEmpty());
+
+		add(journal, store, "one");
+		add(journal, store, "two");
+		add(journal, store, "three");
+		add(journal, store, "four");
+		// four three two one
+		journal.RemoveClip(1);
+		// four two one
+		journal.MoveClipToTop(2, real_time_clock());
+		// one four two
+		journal.RemoveClips(1, 2);
+		// one
+		add(journal, store, "five");
+	}
+
+	history_texts texts;
+	std::vector<int32> pasteCounts;
+	load(directory, texts, &pasteCounts);
+	CHECK(texts.size() == 2);
+	CHECK(texts.size() == 2 && texts[0] == "five" && texts[1] == "one");
+	CHECK(pasteCounts.size() == 2 && pasteCounts[0] == 0
+		&& pasteCounts[1] == 1);
+
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+		journal.Clear();
+		add(journal, store, "six");
+	}
+
+	load(directory, texts);
+	CHECK(texts.size() == 1 && texts[0] == "six");
+}
+
+
+static void
+test_compaction(const char* directory)
+{
+	BString journalPath(directory);
+	journalPath.Append("/").Append(kHistoryJournalFile);
+	BString oldJournalPath(directory);
+	oldJournalPath.Append("/").Append(kHistoryOldJournalFile);
+
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+
+		add(journal, store, "a");
+		add(journal, store, "b");
+
+		// the snapshot covers everything recorded so far
+		history_texts snapshot;
+		snapshot.push_back("b");
+		snapshot.push_back("a");
+		CHECK(journal.Compact(to_entries(store, snapshot), new BList,
+			real_time_clock(), true) == B_OK);
+		CHECK(access(oldJournalPath.String(), F_OK) != 0);
+
+		add(journal, store, "c");
+		journal.MoveClipToTop(2, real_time_clock());
+	}
+
+	// the records from before the snapshot aren't applied twice
+	history_texts texts;
+	load(directory, texts);
+	CHECK(texts.size() == 3);
+	CHECK(texts.size() == 3 && texts[0] == "a" && texts[1] == "c"
+		&& texts[2] == "b");
+
+	// if the snapshot didn't make it, the old journal still counts
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+		add(journal, store, "d");
+	}
+	CHECK(rename(journalPath.String(), oldJournalPath.String()) == 0);
+	load(directory, texts);
+	CHECK(texts.size() == 4 && texts[0] == "d");
+
+	// the journal rotated while the old one was still there comes after it
+	BString pendingJournalPath(directory);
+	pendingJournalPath.Append("/").Append(kHistoryPendingJournalFile);
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+		add(journal, store, "e");
+	}
+	CHECK(rename(journalPath.String(), pendingJournalPath.String()) == 0);
+	load(directory, texts);
+	CHECK(texts.size() == 5 && texts[0] == "e" && texts[1] == "d");
+
+	// a snapshot covers both of them
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		// the snapshot writer takes over the entries
+		CHECK(journal.Compact(new BList(history), new BList(favorites),
+			real_time_clock(), true) == B_OK);
+	}
+	CHECK(access(oldJournalPath.String(), F_OK) != 0);
+	CHECK(access(pendingJournalPath.String(), F_OK) != 0);
+	load(directory, texts);
+	CHECK(texts.size() == 5 && texts[0] == "e" && texts[1] == "d");
+}
+
+
+static void
+test_torn_end(const char* directory)
+{
+	BString journalPath(directory);
+	journalPath.Append("/").Append(kHistoryJournalFile);
+
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+		journal.Clear();
+		add(journal, store, "kept");
+	}
+
+	// half a frame, as a crash in the middle of a write leaves it
+	uint32 torn[2] = { 'Jrnl', 100 };
+	append_raw(journalPath.String(), torn, sizeof(torn));
+
+	history_texts texts;
+	load(directory, texts);
+	CHECK(texts.size() == 1 && texts[0] == "kept");
+
+	// a frame claiming more than there is can't make the replay allocate it
+	truncate(journalPath.String(), 0);
+	{
+		ClipStore store;
+		HistoryJournal journal(directory);
+		BList history;
+		BList favorites;
+		int32 quitTime;
+		journal.Load(&store, &history, &favorites, &quitTime);
+		HistoryFile::EmptyEntries(&history);
+		HistoryFile::EmptyEntries(&favorites);
+		journal.Clear();
+		add(journal, store, "still kept");
+	}
+	uint32 huge[3] = { 'Jrnl', 0xfffffff0, 0 };
+	append_raw(journalPath.String(), huge, sizeof(huge));
+	append_raw(journalPath.String(), "garbage", 7);
+
+	load(directory, texts);
+	CHECK(texts.size() == 1 && texts[0] == "still kept");
+}
+
+
+static void
+make_directory(char* directory)
+{
+	strcpy(directory, "/tmp/clipdinger_journal_test_XXXXXX");
+	if (mkdtemp(directory) == NULL) {
+		perror("mkdtemp");
+		exit(EXIT_FAILURE);
+	}
+}
+
+
+static void
+remove_directory(const char* directory)
+{
+	BDirectory dir(directory);
+	BEntry entry;
+	while (dir.GetNextEntry(&entry) == B_OK)
+		entry.Remove();
+	rmdir(directory);
+}
+
+
+int
+main()
+{
+	char directory[64];
+
+	make_directory(directory);
+	test_replay(directory);
+	remove_directory(directory);
+
+	make_directory(directory);
+	test_compaction(directory);
+	remove_directory(directory);
+
+	make_directory(directory);
+	test_torn_end(directory);
+	remove_directory(directory);
+
+	if (sFailures > 0) {
+		fprintf(stderr, "%d checks failed\n", (int)sFailures);
+		return EXIT_FAILURE;
+	}
+	printf("journal: all checks passed\n");
+	return EXIT_SUCCESS;
+}
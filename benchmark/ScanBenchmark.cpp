@@ -0,0 +1,224 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Compares the TextScan kernels with plain byte by byte scanning over
+// a synthetic corpus of clips, sized like what usually ends up in the
+// clipboard: mostly words, names and URLs, some paragraphs and snippets,
+// a few source files and now and then a whole log.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include "TextScan.h"
+
+static const int32 kClipCount = 2000;
+static const int32 kRuns = 5;
+
+static const char* kWords[] = {
+	"the", "of", "and", "clipboard", "Haiku", "window", "return", "const",
+	"char", "status_t", "BString", "http://", "www.", ".com/", "int32",
+	"if", "else", "for", "while", "Tracker", "Deskbar", "error:", "warning",
+	"Humdinger", "paste", "copy", "void", "{", "}", "(", ")", ";", "=",
+	"0x7f", "UTF-8", "\xc3\xa9t\xc3\xa9", "\xe2\x80\xa6", "Stra\xc3\x9f" "e"
+};
+static const int32 kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+
+static uint32 sSeed = 0x2015;
+
+static uint32
+random_number()
+{
+	// xorshift, the same corpus every time
+	sSeed ^= sSeed << 13;
+	sSeed ^= sSeed >> 17;
+	sSeed ^= sSeed << 5;
+	return sSeed;
+}
+
+
+static size_t
+random_size()
+{
+	uint32 kind = random_number() % 100;
+	if (kind < 60)
+		return 8 + random_number() % 112;
+	if (kind < 85)
+		return 120 + random_number() % 4000;
+	if (kind < 97)
+		return 4096 + random_number() % 61440;
+	return 65536 + random_number() % 983040;
+}
+
+
+static std::string
+make_clip(size_t size)
+{
+	std::string clip;
+	while (clip.size() < size) {
+		clip += kWords[random_number() % kWordCount];
+		uint32 separator = random_number() % 16;
+		clip += separator == 0 ? '\n' : separator == 1 ? '\t' : ' ';
+	}
+	clip.resize(size);
+	return clip;
+}
+
+
+static double
+now()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+
+typedef const char* (*find_no_case_func)(const char*, size_t, const char*,
+	size_t);
+typedef const char* (*find_any_byte_func)(const char*, size_t, const char*,
+	int32);
+
+
+static int64
+count_substrings(const std::vector<std::string>& corpus,
+	find_no_case_func find, const char* needle)
+{
+	size_t needleLength = strlen(needle);
+	int64 count = 0;
+	for (size_t i = 0; i < corpus.size(); i++) {
+		const char* text = corpus[i].data();
+		const char* end = text + corpus[i].size();
+		while (const char* found = find(text, end - text, needle,
+				needleLength)) {
+			count++;
+			text = found + 1;
+		}
+	}
+	return count;
+}
+
+
+static int64
+count_bytes(const std::vector<std::string>& corpus, find_any_byte_func find,
+	const char* needles)
+{
+	int32 needleCount = strlen(needles);
+	int64 count = 0;
+	for (size_t i = 0; i < corpus.size(); i++) {
+		const char* text = corpus[i].data();
+		const char* end = text + corpus[i].size();
+		while (const char* found = find(text, end - text, needles,
+				needleCount)) {
+			count++;
+			text = found + 1;
+		}
+	}
+	return count;
+}
+
+
+template<typename Function>
+static double
+best_time(Function function, int64& result)
+{
+	double best = 0;
+	for (int32 run = 0; run < kRuns; run++) {
+		double start = now();
+		result = function();
+		double time = now() - start;
+		if (run == 0 || time < best)
+			best = time;
+	}
+	return best;
+}
+
+
+struct substring_run {
+	const std::vector<std::string>& corpus;
+	find_no_case_func find;
+	const char* needle;
+	int64 operator()() const { return count_substrings(corpus, find, needle); }
+};
+
+
+struct byte_run {
+	const std::vector<std::string>& corpus;
+	find_any_byte_func find;
+	const char* needles;
+	int64 operator()() const { return count_bytes(corpus, find, needles); }
+};
+
+
+int
+main()
+{
+	std::vector<std::string> corpus;
+	size_t corpusSize = 0;
+	for (int32 i = 0; i < kClipCount; i++) {
+		corpus.push_back(make_clip(random_size()));
+		corpusSize += corpus.back().size();
+	}
+	double megabytes = corpusSize / (1024.0 * 1024.0);
+	printf("corpus: %d clips, %.1f MiB\n\n", (int)kClipCount, megabytes);
+
+	int failures = 0;
+
+	// needles are in lower case, as the filter passes them
+	static const char* kNeedles[] = { "clipboard", "haiku", "zq", "x",
+		"status_t bstring", "\xc3\xa9t\xc3\xa9" };
+	printf("%-20s %12s %12s %9s\n", "substring (no case)", "naive MiB/s",
+		"kernel MiB/s", "speedup");
+	for (size_t i = 0; i < sizeof(kNeedles) / sizeof(kNeedles[0]); i++) {
+		int64 naiveCount;
+		int64 kernelCount;
+		substring_run naive = { corpus, TextScan::FindNoCaseScalar,
+			kNeedles[i] };
+		substring_run kernel = { corpus, TextScan::FindNoCase, kNeedles[i] };
+		double naiveTime = best_time(naive, naiveCount);
+		double kernelTime = best_time(kernel, kernelCount);
+		printf("%-20s %12.0f %12.0f %8.1fx%s\n", kNeedles[i],
+			megabytes / naiveTime, megabytes / kernelTime,
+			naiveTime / kernelTime,
+			naiveCount != kernelCount ? "  MISMATCH" : "");
+		if (naiveCount != kernelCount)
+			failures++;
+	}
+
+	static const char* kByteSets[] = { "qQ", "zZxX", "\n\t", "{}()" };
+	printf("\n%-20s %12s %12s %9s\n", "any byte", "naive MiB/s",
+		"kernel MiB/s", "speedup");
+	for (size_t i = 0; i < sizeof(kByteSets) / sizeof(kByteSets[0]); i++) {
+		int64 naiveCount;
+		int64 kernelCount;
+		byte_run naive = { corpus, TextScan::FindAnyByteScalar,
+			kByteSets[i] };
+		byte_run kernel = { corpus, TextScan::FindAnyByte, kByteSets[i] };
+		double naiveTime = best_time(naive, naiveCount);
+		double kernelTime = best_time(kernel, kernelCount);
+
+		std::string name;
+		for (const char* c = kByteSets[i]; *c != '\0'; c++) {
+			name += *c == '\n' ? "\\n" : *c == '\t' ? "\\t"
+				: std::string(1, *c);
+		}
+		printf("%-20s %12.0f %12.0f %8.1fx%s\n", name.c_str(),
+			megabytes / naiveTime, megabytes / kernelTime,
+			naiveTime / kernelTime,
+			naiveCount != kernelCount ? "  MISMATCH" : "");
+		if (naiveCount != kernelCount)
+			failures++;
+	}
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _AUTOLOCK_H
+#define _AUTOLOCK_H
+
+#include "Locker.h"
+
+
+class BAutolock {
+public:
+						BAutolock(BLocker& locker)
+							: fLocker(locker) { fLocker.Lock(); }
+						~BAutolock() { fLocker.Unlock(); }
+
+private:
+	BLocker&			fLocker;
+};
+
+#endif // _AUTOLOCK_H
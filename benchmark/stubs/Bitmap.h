@@ -0,0 +1,17 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _BITMAP_H
+#define _BITMAP_H
+
+class BBitmap;
+
+#endif // _BITMAP_H
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _BUFFER_IO_H
+#define _BUFFER_IO_H
+
+#include <string.h>
+
+#include <vector>
+
+#include "File.h"
+
+
+class BBufferIO : public BDataIO {
+public:
+						BBufferIO(BDataIO* stream, size_t bufferSize,
+								bool ownsStream)
+							: fStream(stream), fSize(bufferSize)
+							{ fBuffer.reserve(bufferSize); }
+	virtual				~BBufferIO() { Flush(); }
+
+	virtual	ssize_t		Read(void* buffer, size_t size)
+							{ return fStream->Read(buffer, size); }
+	virtual	ssize_t		Write(const void* buffer, size_t size)
+							{ if (fBuffer.size() + size > fSize
+								&& Flush() != B_OK)
+								return B_IO_ERROR;
+							if (size >= fSize)
+								return fStream->Write(buffer, size);
+							fBuffer.insert(fBuffer.end(), (const char*)buffer,
+								(const char*)buffer + size);
+							return size; }
+	status_t			Flush()
+							{ if (fBuffer.empty())
+								return B_OK;
+							ssize_t written = fStream->Write(fBuffer.data(),
+								fBuffer.size());
+							bool complete = written == (ssize_t)fBuffer.size();
+							fBuffer.clear();
+							return complete ? B_OK : B_IO_ERROR; }
+
+private:
+	BDataIO*			fStream;
+	size_t				fSize;
+	std::vector<char>	fBuffer;
+};
+
+#endif // _BUFFER_IO_H
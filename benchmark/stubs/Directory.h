@@ -0,0 +1,66 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _DIRECTORY_H
+#define _DIRECTORY_H
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "Entry.h"
+
+
+class BDirectory {
+public:
+						BDirectory(const char* path)
+							: fPath(path)
+							{ fDirectory = path != NULL ? opendir(path) : NULL; }
+						~BDirectory()
+							{ if (fDirectory != NULL)
+								closedir(fDirectory); }
+
+	status_t			GetNextEntry(BEntry* entry)
+							{ struct dirent* next;
+							do {
+								next = fDirectory != NULL
+									? readdir(fDirectory) : NULL;
+							} while (next != NULL && next->d_name[0] == '.');
+							if (next == NULL)
+								return B_ENTRY_NOT_FOUND;
+							BString path(fPath);
+							path.Append("/").Append(next->d_name);
+							return entry->SetTo(path.String()); }
+
+private:
+	BString				fPath;
+	DIR*				fDirectory;
+};
+
+
+static inline status_t
+create_directory(const char* path, mode_t mode)
+{
+	struct stat st;
+	if (stat(path, &st) == 0)
+		return S_ISDIR(st.st_mode) ? B_OK : B_BAD_VALUE;
+
+	BString parent(path);
+	const char* slash = strrchr(path, '/');
+	if (slash != NULL && slash != path) {
+		parent.SetTo(path, slash - path);
+		status_t status = create_directory(parent.String(), mode);
+		if (status != B_OK)
+			return status;
+	}
+	return mkdir(path, mode) == 0 ? B_OK : B_IO_ERROR;
+}
+
+#endif // _DIRECTORY_H
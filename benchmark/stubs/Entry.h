@@ -0,0 +1,57 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _ENTRY_H
+#define _ENTRY_H
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "OS.h"
+#include "String.h"
+
+
+class BEntry {
+public:
+						BEntry() {}
+						BEntry(const char* path) { SetTo(path); }
+
+	status_t			SetTo(const char* path)
+							{ fPath = path; return B_OK; }
+	status_t			GetName(char* name) const
+							{ const char* leaf = strrchr(fPath.String(), '/');
+							strcpy(name, leaf != NULL ? leaf + 1
+								: fPath.String());
+							return B_OK; }
+	status_t			Rename(const char* path, bool clobber = false)
+							{ if (rename(fPath.String(), path) != 0)
+								return B_IO_ERROR;
+							fPath = path;
+							return B_OK; }
+	bool				Exists() const
+							{ return access(fPath.String(), F_OK) == 0; }
+	status_t			GetSize(off_t* size) const
+							{ struct stat st;
+							if (stat(fPath.String(), &st) != 0)
+								return B_ENTRY_NOT_FOUND;
+							*size = st.st_size;
+							return B_OK; }
+	status_t			Remove()
+							{ return unlink(fPath.String()) == 0
+								? B_OK : B_ENTRY_NOT_FOUND; }
+
+private:
+	BString				fPath;
+};
+
+#endif // _ENTRY_H
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _FILE_H
+#define _FILE_H
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SupportDefs.h"
+
+#define B_READ_ONLY		O_RDONLY
+#define B_WRITE_ONLY	O_WRONLY
+#define B_READ_WRITE	O_RDWR
+#define B_CREATE_FILE	O_CREAT
+#define B_ERASE_FILE	O_TRUNC
+#define B_OPEN_AT_END	O_APPEND
+
+
+class BDataIO {
+public:
+	virtual				~BDataIO() {}
+	virtual	ssize_t		Read(void* buffer, size_t size) = 0;
+	virtual	ssize_t		Write(const void* buffer, size_t size) = 0;
+};
+
+
+class BFile : public BDataIO {
+public:
+						BFile() : fFD(-1) {}
+						BFile(const char* path, uint32 mode)
+							{ fFD = open(path, mode, 0644); }
+	virtual				~BFile() { Unset(); }
+
+	status_t			SetTo(const char* path, uint32 mode)
+							{ Unset();
+							fFD = open(path, mode, 0644);
+							return InitCheck(); }
+
+	status_t			InitCheck() const
+							{ return fFD >= 0 ? B_OK : B_ENTRY_NOT_FOUND; }
+	void				Unset()
+							{ if (fFD >= 0)
+								close(fFD);
+							fFD = -1; }
+
+	virtual	ssize_t		Read(void* buffer, size_t size)
+							{ ssize_t bytes = read(fFD, buffer, size);
+							return bytes >= 0 ? bytes : B_IO_ERROR; }
+	virtual	ssize_t		Write(const void* buffer, size_t size)
+							{ ssize_t bytes = write(fFD, buffer, size);
+							return bytes >= 0 ? bytes : B_IO_ERROR; }
+	status_t			Sync()
+							{ return fsync(fFD) == 0 ? B_OK : B_IO_ERROR; }
+	status_t			GetSize(off_t* size) const
+							{ struct stat st;
+							if (fstat(fFD, &st) != 0)
+								return B_NO_INIT;
+							*size = st.st_size;
+							return B_OK; }
+
+private:
+	int					fFD;
+};
+
+#endif // _FILE_H
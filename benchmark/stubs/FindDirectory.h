@@ -0,0 +1,37 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _FIND_DIRECTORY_H
+#define _FIND_DIRECTORY_H
+
+#include <stdlib.h>
+
+#include "Path.h"
+
+enum directory_which {
+	B_USER_SETTINGS_DIRECTORY
+};
+
+
+// the settings live below $HOME/config/settings, as on Haiku
+static inline status_t
+find_directory(directory_which which, BPath* path, bool createIt = false,
+	void* volume = NULL)
+{
+	const char* home = getenv("HOME");
+	if (home == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	path->SetTo(home);
+	return path->Append("config/settings");
+}
+
+#endif // _FIND_DIRECTORY_H
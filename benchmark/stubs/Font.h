@@ -0,0 +1,37 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _FONT_H
+#define _FONT_H
+
+#include "String.h"
+
+
+struct font_height {
+	float				ascent;
+	float				descent;
+	float				leading;
+};
+
+
+class BFont {
+public:
+	uint32				FamilyAndStyle() const { return 0; }
+	float				Size() const { return 12; }
+	// about half an em per character
+	void				TruncateString(BString* string, uint32 mode,
+							float width) const
+							{ int32 chars = (int32)(width / 6);
+							if (string->Length() > chars)
+								string->SetTo(string->String(), chars); }
+};
+
+#endif // _FONT_H
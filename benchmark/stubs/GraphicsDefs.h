@@ -0,0 +1,31 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _GRAPHICS_DEFS_H
+#define _GRAPHICS_DEFS_H
+
+#include "SupportDefs.h"
+
+
+struct rgb_color {
+	uint8				red;
+	uint8				green;
+	uint8				blue;
+	uint8				alpha;
+
+	bool operator==(const rgb_color& other) const
+		{ return red == other.red && green == other.green
+			&& blue == other.blue && alpha == other.alpha; }
+	bool operator!=(const rgb_color& other) const
+		{ return !(*this == other); }
+};
+
+#endif // _GRAPHICS_DEFS_H
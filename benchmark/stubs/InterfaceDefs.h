@@ -0,0 +1,49 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _INTERFACE_DEFS_H
+#define _INTERFACE_DEFS_H
+
+#include "GraphicsDefs.h"
+
+enum color_which {
+	B_LIST_BACKGROUND_COLOR = 0
+};
+
+enum {
+	B_TRUNCATE_END = 1
+};
+
+#define B_NO_TINT		1.0f
+
+
+static inline rgb_color
+ui_color(color_which which)
+{
+	rgb_color color = { 255, 255, 255, 255 };
+	return color;
+}
+
+
+static inline rgb_color
+tint_color(rgb_color color, float tint)
+{
+	// darkening only, like the fading does
+	float factor = 2.0f - tint;
+	if (factor < 0)
+		factor = 0;
+	rgb_color tinted = { (uint8)(color.red * factor),
+		(uint8)(color.green * factor), (uint8)(color.blue * factor),
+		color.alpha };
+	return tinted;
+}
+
+#endif // _INTERFACE_DEFS_H
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _BE_LIST_H
+#define _BE_LIST_H
+
+#include <algorithm>
+#include <vector>
+
+#include "SupportDefs.h"
+
+
+class BList {
+public:
+						BList(int32 count = 20) { fItems.reserve(count); }
+
+	bool				AddItem(void* item)
+							{ fItems.push_back(item); return true; }
+	bool				AddItem(void* item, int32 index)
+							{ if (index < 0 || index > CountItems())
+								return false;
+							fItems.insert(fItems.begin() + index, item);
+							return true; }
+	bool				AddList(const BList* list)
+							{ fItems.insert(fItems.end(),
+								list->fItems.begin(), list->fItems.end());
+							return true; }
+	void*				RemoveItem(int32 index)
+							{ void* item = ItemAt(index);
+							if (item != NULL)
+								fItems.erase(fItems.begin() + index);
+							return item; }
+	bool				RemoveItems(int32 index, int32 count)
+							{ if (index < 0 || index + count > CountItems())
+								return false;
+							fItems.erase(fItems.begin() + index,
+								fItems.begin() + index + count);
+							return true; }
+	bool				MoveItem(int32 from, int32 to)
+							{ void* item = RemoveItem(from);
+							return item != NULL && AddItem(item, to); }
+	void				MakeEmpty() { fItems.clear(); }
+
+	void*				ItemAt(int32 index) const
+							{ return index >= 0 && index < CountItems()
+								? fItems[index] : NULL; }
+	void**				Items() const { return (void**)fItems.data(); }
+	int32				IndexOf(void* item) const
+							{ std::vector<void*>::const_iterator found
+								= std::find(fItems.begin(), fItems.end(),
+									item);
+							return found != fItems.end()
+								? found - fItems.begin() : -1; }
+	int32				CountItems() const { return fItems.size(); }
+	bool				IsEmpty() const { return fItems.empty(); }
+
+private:
+	std::vector<void*>	fItems;
+};
+
+#endif // _BE_LIST_H
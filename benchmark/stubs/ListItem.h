@@ -0,0 +1,36 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _LIST_ITEM_H
+#define _LIST_ITEM_H
+
+#include "SupportDefs.h"
+
+class BView;
+
+
+struct BRect {
+	float				left;
+	float				top;
+	float				right;
+	float				bottom;
+};
+
+
+class BListItem {
+public:
+	virtual				~BListItem() {}
+
+	virtual	void		DrawItem(BView* owner, BRect frame,
+							bool complete = false) = 0;
+};
+
+#endif // _LIST_ITEM_H
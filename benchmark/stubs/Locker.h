@@ -0,0 +1,38 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _LOCKER_H
+#define _LOCKER_H
+
+#include <pthread.h>
+
+#include "SupportDefs.h"
+
+
+class BLocker {
+public:
+						BLocker(const char* name = NULL)
+							{ pthread_mutexattr_t attributes;
+							pthread_mutexattr_init(&attributes);
+							pthread_mutexattr_settype(&attributes,
+								PTHREAD_MUTEX_RECURSIVE);
+							pthread_mutex_init(&fMutex, &attributes);
+							pthread_mutexattr_destroy(&attributes); }
+						~BLocker() { pthread_mutex_destroy(&fMutex); }
+
+	bool				Lock() { return pthread_mutex_lock(&fMutex) == 0; }
+	void				Unlock() { pthread_mutex_unlock(&fMutex); }
+
+private:
+	pthread_mutex_t		fMutex;
+};
+
+#endif // _LOCKER_H
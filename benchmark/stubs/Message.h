@@ -0,0 +1,268 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+// Flattened messages have a layout of their own, they can only be read
+// back by this stand-in, not by Haiku.
+
+#ifndef _MESSAGE_H
+#define _MESSAGE_H
+
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "File.h"
+#include "String.h"
+#include "SupportDefs.h"
+
+#define B_BOOL_TYPE			'BOOL'
+#define B_INT32_TYPE		'LONG'
+#define B_INT64_TYPE		'LLNG'
+#define B_STRING_TYPE		'CSTR'
+#define B_MESSAGE_TYPE		'MSGG'
+#define B_MIME_TYPE			'MIME'
+
+enum {
+	B_NAME_NOT_FOUND	= B_ENTRY_NOT_FOUND + 1,
+	B_BAD_TYPE,
+	B_BAD_INDEX
+};
+
+
+class BMessage {
+public:
+						BMessage(uint32 what = 0) : what(what) {}
+
+	void				MakeEmpty() { fFields.clear(); }
+
+	status_t			AddData(const char* name, type_code type,
+							const void* data, ssize_t size,
+							bool fixedSize = true, int32 count = 1)
+							{ field& values = fFields[name];
+							if (!values.items.empty() && values.type != type)
+								return B_BAD_TYPE;
+							values.type = type;
+							values.items.push_back(
+								std::string((const char*)data, size));
+							return B_OK; }
+	status_t			FindData(const char* name, type_code type,
+							int32 index, const void** data,
+							ssize_t* size) const
+							{ std::map<std::string, field>::const_iterator
+								found = fFields.find(name);
+							if (found == fFields.end())
+								return B_NAME_NOT_FOUND;
+							if (found->second.type != type)
+								return B_BAD_TYPE;
+							if (index < 0 || index
+									>= (int32)found->second.items.size())
+								return B_BAD_INDEX;
+							const std::string& item
+								= found->second.items[index];
+							*data = item.data();
+							*size = item.size();
+							return B_OK; }
+	status_t			FindData(const char* name, type_code type,
+							const void** data, ssize_t* size) const
+							{ return FindData(name, type, 0, data, size); }
+	bool				HasData(const char* name, type_code type) const
+							{ const void* data;
+							ssize_t size;
+							return FindData(name, type, &data, &size)
+								== B_OK; }
+
+	status_t			AddBool(const char* name, bool value)
+							{ return AddData(name, B_BOOL_TYPE, &value,
+								sizeof(value)); }
+	status_t			AddInt32(const char* name, int32 value)
+							{ return AddData(name, B_INT32_TYPE, &value,
+								sizeof(value)); }
+	status_t			AddInt64(const char* name, int64 value)
+							{ return AddData(name, B_INT64_TYPE, &value,
+								sizeof(value)); }
+	status_t			AddString(const char* name, const char* string)
+							{ return AddData(name, B_STRING_TYPE, string,
+								strlen(string) + 1, false); }
+	status_t			AddString(const char* name, const BString& string)
+							{ return AddString(name, string.String()); }
+	status_t			AddMessage(const char* name,
+							const BMessage* message)
+							{ std::string flat(message->FlattenedSize(),
+								'\0');
+							message->Flatten(&flat[0], flat.size());
+							return AddData(name, B_MESSAGE_TYPE,
+								flat.data(), flat.size(), false); }
+
+	status_t			FindBool(const char* name, bool* value) const
+							{ return _Find(name, B_BOOL_TYPE, 0, value); }
+	status_t			FindInt32(const char* name, int32* value) const
+							{ return _Find(name, B_INT32_TYPE, 0, value); }
+	status_t			FindInt32(const char* name, int32 index,
+							int32* value) const
+							{ return _Find(name, B_INT32_TYPE, index,
+								value); }
+	status_t			FindInt64(const char* name, int64* value) const
+							{ return _Find(name, B_INT64_TYPE, 0, value); }
+	status_t			FindString(const char* name, int32 index,
+							const char** string) const
+							{ ssize_t size;
+							return FindData(name, B_STRING_TYPE, index,
+								(const void**)string, &size); }
+	status_t			FindString(const char* name,
+							const char** string) const
+							{ return FindString(name, 0, string); }
+	status_t			FindString(const char* name, int32 index,
+							BString* string) const
+							{ const char* value;
+							status_t status = FindString(name, index,
+								&value);
+							if (status == B_OK)
+								*string = value;
+							return status; }
+	status_t			FindString(const char* name, BString* string) const
+							{ return FindString(name, 0, string); }
+
+	bool				GetBool(const char* name, bool value) const
+							{ FindBool(name, &value);
+							return value; }
+	int32				GetInt32(const char* name, int32 value) const
+							{ FindInt32(name, &value);
+							return value; }
+	int64				GetInt64(const char* name, int64 value) const
+							{ FindInt64(name, &value);
+							return value; }
+
+	// the size first, so the message can be read from a stream
+	ssize_t				FlattenedSize() const
+							{ ssize_t size = 3 * sizeof(uint32);
+							std::map<std::string, field>::const_iterator it;
+							for (it = fFields.begin(); it != fFields.end();
+									it++) {
+								size += 3 * sizeof(uint32) + it->first.size();
+								for (size_t i = 0; i < it->second.items.size();
+										i++) {
+									size += sizeof(uint32)
+										+ it->second.items[i].size();
+								}
+							}
+							return size; }
+	status_t			Flatten(char* buffer, ssize_t size) const
+							{ if (size < FlattenedSize())
+								return B_BAD_VALUE;
+							_Put(buffer, FlattenedSize());
+							_Put(buffer, what);
+							_Put(buffer, fFields.size());
+							std::map<std::string, field>::const_iterator it;
+							for (it = fFields.begin(); it != fFields.end();
+									it++) {
+								_Put(buffer, it->second.type);
+								_Put(buffer, it->first);
+								_Put(buffer, it->second.items.size());
+								for (size_t i = 0; i < it->second.items.size();
+										i++)
+									_Put(buffer, it->second.items[i]);
+							}
+							return B_OK; }
+	status_t			Unflatten(const char* buffer)
+							{ uint32 size;
+							memcpy(&size, buffer, sizeof(size));
+							return _Unflatten(buffer, size); }
+	status_t			Unflatten(BDataIO* stream)
+							{ uint32 size;
+							if (stream->Read(&size, sizeof(size))
+									!= sizeof(size)
+								|| size < 3 * sizeof(uint32))
+								return B_BAD_DATA;
+							std::string flat(size, '\0');
+							memcpy(&flat[0], &size, sizeof(size));
+							ssize_t rest = size - sizeof(size);
+							if (stream->Read(&flat[sizeof(size)], rest)
+									!= rest)
+								return B_BAD_DATA;
+							return _Unflatten(flat.data(), size); }
+
+	uint32				what;
+
+private:
+	struct field {
+		type_code					type;
+		std::vector<std::string>	items;
+	};
+
+	template<typename Type>
+	status_t			_Find(const char* name, type_code type,
+							int32 index, Type* value) const
+							{ const void* data;
+							ssize_t size;
+							status_t status = FindData(name, type, index,
+								&data, &size);
+							if (status == B_OK && size != sizeof(Type))
+								status = B_BAD_DATA;
+							if (status == B_OK)
+								memcpy(value, data, sizeof(Type));
+							return status; }
+
+	static void			_Put(char*& buffer, uint32 value)
+							{ memcpy(buffer, &value, sizeof(value));
+							buffer += sizeof(value); }
+	static void			_Put(char*& buffer, const std::string& data)
+							{ _Put(buffer, data.size());
+							memcpy(buffer, data.data(), data.size());
+							buffer += data.size(); }
+	static bool			_Get(const char*& buffer, const char* end,
+							uint32& value)
+							{ if (end - buffer < (ssize_t)sizeof(value))
+								return false;
+							memcpy(&value, buffer, sizeof(value));
+							buffer += sizeof(value);
+							return true; }
+	static bool			_Get(const char*& buffer, const char* end,
+							std::string& data)
+							{ uint32 size;
+							if (!_Get(buffer, end, size)
+								|| (uint32)(end - buffer) < size)
+								return false;
+							data.assign(buffer, size);
+							buffer += size;
+							return true; }
+
+	status_t			_Unflatten(const char* buffer, uint32 size)
+							{ const char* end = buffer + size;
+							buffer += sizeof(uint32);
+							uint32 count;
+							fFields.clear();
+							if (!_Get(buffer, end, what)
+								|| !_Get(buffer, end, count))
+								return B_BAD_DATA;
+							for (uint32 i = 0; i < count; i++) {
+								uint32 type;
+								std::string name;
+								uint32 items;
+								if (!_Get(buffer, end, type)
+									|| !_Get(buffer, end, name)
+									|| !_Get(buffer, end, items))
+									return B_BAD_DATA;
+								field& values = fFields[name];
+								values.type = type;
+								for (uint32 j = 0; j < items; j++) {
+									std::string item;
+									if (!_Get(buffer, end, item))
+										return B_BAD_DATA;
+									values.items.push_back(item);
+								}
+							}
+							return B_OK; }
+
+	std::map<std::string, field> fFields;
+};
+
+#endif // _MESSAGE_H
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _OS_H
+#define _OS_H
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <map>
+
+#include "SupportDefs.h"
+
+#define B_FILE_NAME_LENGTH	256
+#define B_LOW_PRIORITY		5
+#define B_NORMAL_PRIORITY	10
+
+typedef int32		thread_id;
+typedef status_t	(*thread_func)(void*);
+
+static inline bigtime_t
+system_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (bigtime_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+
+static inline uint32
+real_time_clock()
+{
+	return (uint32)time(NULL);
+}
+
+
+static inline int32
+atomic_add(int32* value, int32 addValue)
+{
+	return __sync_fetch_and_add(value, addValue);
+}
+
+
+static inline int32
+atomic_or(int32* value, int32 orValue)
+{
+	return __sync_fetch_and_or(value, orValue);
+}
+
+
+static inline int32
+atomic_get(int32* value)
+{
+	return __sync_fetch_and_add(value, 0);
+}
+
+
+static inline int32
+atomic_set(int32* value, int32 newValue)
+{
+	return __sync_lock_test_and_set(value, newValue);
+}
+
+
+static inline int64
+atomic_add64(int64* value, int64 addValue)
+{
+	return __sync_fetch_and_add(value, addValue);
+}
+
+
+static inline int64
+atomic_get64(int64* value)
+{
+	return __sync_fetch_and_add(value, 0);
+}
+
+
+static inline int64
+atomic_set64(int64* value, int64 newValue)
+{
+	return __sync_lock_test_and_set(value, newValue);
+}
+
+
+// Threads are started right away, there's no suspended state to resume
+// from. Their ids are handed out here, pthread_t isn't an integer.
+
+struct stub_thread {
+	thread_func			function;
+	void*				data;
+};
+
+
+inline std::map<thread_id, pthread_t>&
+stub_threads(pthread_mutex_t** lock)
+{
+	static pthread_mutex_t sLock = PTHREAD_MUTEX_INITIALIZER;
+	static std::map<thread_id, pthread_t> sThreads;
+	*lock = &sLock;
+	return sThreads;
+}
+
+
+inline void*
+stub_thread_entry(void* data)
+{
+	stub_thread thread = *(stub_thread*)data;
+	delete (stub_thread*)data;
+	return (void*)(intptr_t)thread.function(thread.data);
+}
+
+
+inline thread_id
+spawn_thread(thread_func function, const char* name, int32 priority,
+	void* data)
+{
+	static int32 sNextID = 1;
+
+	stub_thread* thread = new stub_thread;
+	thread->function = function;
+	thread->data = data;
+	pthread_t pthread;
+	if (pthread_create(&pthread, NULL, stub_thread_entry, thread) != 0) {
+		delete thread;
+		return B_NO_MEMORY;
+	}
+
+	pthread_mutex_t* lock;
+	std::map<thread_id, pthread_t>& threads = stub_threads(&lock);
+	pthread_mutex_lock(lock);
+	thread_id id = sNextID++;
+	threads[id] = pthread;
+	pthread_mutex_unlock(lock);
+	return id;
+}
+
+
+static inline status_t
+resume_thread(thread_id thread)
+{
+	return B_OK;
+}
+
+
+inline status_t
+wait_for_thread(thread_id thread, status_t* result)
+{
+	pthread_mutex_t* lock;
+	std::map<thread_id, pthread_t>& threads = stub_threads(&lock);
+	pthread_mutex_lock(lock);
+	std::map<thread_id, pthread_t>::iterator found = threads.find(thread);
+	if (found == threads.end()) {
+		pthread_mutex_unlock(lock);
+		return B_BAD_VALUE;
+	}
+	pthread_t pthread = found->second;
+	threads.erase(found);
+	pthread_mutex_unlock(lock);
+
+	void* value;
+	if (pthread_join(pthread, &value) != 0)
+		return B_BAD_VALUE;
+	*result = (status_t)(intptr_t)value;
+	return B_OK;
+}
+
+
+// Semaphores are counted in a condition variable. A deleted one wakes up
+// whoever waits on it, but is only freed with the process.
+
+typedef int32		sem_id;
+
+static const status_t B_BAD_SEM_ID = B_ENTRY_NOT_FOUND + 1;
+
+struct stub_sem {
+	pthread_mutex_t		lock;
+	pthread_cond_t		changed;
+	int32				count;
+	bool				deleted;
+};
+
+
+inline std::map<sem_id, stub_sem*>&
+stub_sems(pthread_mutex_t** lock)
+{
+	static pthread_mutex_t sLock = PTHREAD_MUTEX_INITIALIZER;
+	static std::map<sem_id, stub_sem*> sSems;
+	*lock = &sLock;
+	return sSems;
+}
+
+
+inline stub_sem*
+stub_find_sem(sem_id id)
+{
+	pthread_mutex_t* lock;
+	std::map<sem_id, stub_sem*>& sems = stub_sems(&lock);
+	pthread_mutex_lock(lock);
+	std::map<sem_id, stub_sem*>::iterator found = sems.find(id);
+	stub_sem* sem = found != sems.end() ? found->second : NULL;
+	pthread_mutex_unlock(lock);
+	return sem;
+}
+
+
+inline sem_id
+create_sem(int32 count, const char* name)
+{
+	static int32 sNextID = 1;
+
+	stub_sem* sem = new stub_sem;
+	pthread_mutex_init(&sem->lock, NULL);
+	pthread_cond_init(&sem->changed, NULL);
+	sem->count = count;
+	sem->deleted = false;
+
+	pthread_mutex_t* lock;
+	std::map<sem_id, stub_sem*>& sems = stub_sems(&lock);
+	pthread_mutex_lock(lock);
+	sem_id id = sNextID++;
+	sems[id] = sem;
+	pthread_mutex_unlock(lock);
+	return id;
+}
+
+
+inline status_t
+delete_sem(sem_id id)
+{
+	stub_sem* sem = stub_find_sem(id);
+	if (sem == NULL)
+		return B_BAD_SEM_ID;
+
+	pthread_mutex_lock(&sem->lock);
+	bool deleted = sem->deleted;
+	sem->deleted = true;
+	pthread_cond_broadcast(&sem->changed);
+	pthread_mutex_unlock(&sem->lock);
+	return deleted ? B_BAD_SEM_ID : B_OK;
+}
+
+
+// the flags and the timeout are ignored, it always waits
+inline status_t
+acquire_sem_etc(sem_id id, int32 count, uint32 flags, bigtime_t timeout)
+{
+	stub_sem* sem = stub_find_sem(id);
+	if (sem == NULL)
+		return B_BAD_SEM_ID;
+
+	pthread_mutex_lock(&sem->lock);
+	while (!sem->deleted && sem->count < count)
+		pthread_cond_wait(&sem->changed, &sem->lock);
+	status_t status = sem->deleted ? B_BAD_SEM_ID : B_OK;
+	if (status == B_OK)
+		sem->count -= count;
+	pthread_mutex_unlock(&sem->lock);
+	return status;
+}
+
+
+inline status_t
+acquire_sem(sem_id id)
+{
+	return acquire_sem_etc(id, 1, 0, 0);
+}
+
+
+inline status_t
+release_sem(sem_id id)
+{
+	stub_sem* sem = stub_find_sem(id);
+	if (sem == NULL)
+		return B_BAD_SEM_ID;
+
+	pthread_mutex_lock(&sem->lock);
+	status_t status = sem->deleted ? B_BAD_SEM_ID : B_OK;
+	if (status == B_OK) {
+		sem->count++;
+		pthread_cond_broadcast(&sem->changed);
+	}
+	pthread_mutex_unlock(&sem->lock);
+	return status;
+}
+
+
+inline status_t
+get_sem_count(sem_id id, int32* count)
+{
+	stub_sem* sem = stub_find_sem(id);
+	if (sem == NULL)
+		return B_BAD_SEM_ID;
+
+	pthread_mutex_lock(&sem->lock);
+	status_t status = sem->deleted ? B_BAD_SEM_ID : B_OK;
+	*count = sem->count;
+	pthread_mutex_unlock(&sem->lock);
+	return status;
+}
+
+
+inline thread_id
+find_thread(const char* name)
+{
+	// any number that differs between threads will do
+	static int32 sNextID = 1;
+	static __thread thread_id sID = 0;
+	if (sID == 0)
+		sID = __sync_fetch_and_add(&sNextID, 1);
+	return sID;
+}
+
+#endif // _OS_H
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _PATH_H
+#define _PATH_H
+
+#include "String.h"
+
+
+class BPath {
+public:
+						BPath() : fStatus(B_NO_INIT) {}
+						BPath(const char* path) { SetTo(path); }
+
+	status_t			InitCheck() const { return fStatus; }
+	status_t			SetTo(const char* path)
+							{ fPath = path;
+							fStatus = path != NULL && path[0] != '\0'
+								? B_OK : B_BAD_VALUE;
+							return fStatus; }
+	status_t			Append(const char* leaf)
+							{ if (fStatus != B_OK)
+								return fStatus;
+							fPath.Append("/").Append(leaf);
+							return B_OK; }
+	const char*			Path() const
+							{ return fStatus == B_OK ? fPath.String() : NULL; }
+
+private:
+	BString				fPath;
+	status_t			fStatus;
+};
+
+#endif // _PATH_H
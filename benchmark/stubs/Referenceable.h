@@ -0,0 +1,36 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _REFERENCEABLE_H
+#define _REFERENCEABLE_H
+
+#include "OS.h"
+
+
+class BReferenceable {
+public:
+						BReferenceable() : fReferenceCount(1) {}
+	virtual				~BReferenceable() {}
+
+	int32				AcquireReference()
+							{ return atomic_add(&fReferenceCount, 1); }
+	int32				ReleaseReference()
+							{ int32 previous = atomic_add(&fReferenceCount, -1);
+							if (previous == 1)
+								delete this;
+							return previous; }
+	int32				CountReferences() const { return fReferenceCount; }
+
+private:
+	int32				fReferenceCount;
+};
+
+#endif // _REFERENCEABLE_H
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _B_STRING_H
+#define _B_STRING_H
+
+#include <ctype.h>
+#include <string.h>
+
+#include <string>
+
+#include "SupportDefs.h"
+
+
+class BString {
+public:
+						BString() {}
+						BString(const char* string)
+							{ if (string != NULL) fString = string; }
+						BString(const char* string, int32 length)
+							{ SetTo(string, length); }
+
+	const char*			String() const { return fString.c_str(); }
+	int32				Length() const { return fString.size(); }
+	bool				IsEmpty() const { return fString.empty(); }
+
+	BString&			SetTo(const char* string, int32 length)
+							{ fString.assign(string,
+								strnlen(string, length)); return *this; }
+	BString&			Append(const char* string)
+							{ fString += string; return *this; }
+	BString&			operator=(const char* string)
+							{ fString = string != NULL ? string : "";
+								return *this; }
+	BString&			operator+=(const char* string)
+							{ return Append(string); }
+	BString&			ToLower()
+							{
+								for (size_t i = 0; i < fString.size(); i++)
+									fString[i] = tolower((uint8)fString[i]);
+								return *this;
+							}
+
+	bool				operator==(const BString& other) const
+							{ return fString == other.fString; }
+	bool				operator!=(const BString& other) const
+							{ return fString != other.fString; }
+	bool				operator<(const BString& other) const
+							{ return fString < other.fString; }
+	bool				operator!=(const char* string) const
+							{ return fString != (string != NULL ? string : ""); }
+
+	char*				LockBuffer(int32 maxLength)
+							{ fString.resize(maxLength); return &fString[0]; }
+	BString&			UnlockBuffer(int32 length = -1)
+							{ fString.resize(length >= 0 ? length
+								: strlen(fString.c_str())); return *this; }
+
+private:
+	std::string			fString;
+};
+
+#endif // _B_STRING_H
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+// Stand-in for the Haiku header, just enough to build the parts of
+// Clipdinger that are benchmarked on other systems.
+
+#ifndef _SUPPORT_DEFS_H
+#define _SUPPORT_DEFS_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef int8_t		int8;
+typedef uint8_t		uint8;
+typedef int16_t		int16;
+typedef uint16_t	uint16;
+typedef int32_t		int32;
+typedef uint32_t	uint32;
+typedef int64_t		int64;
+typedef uint64_t	uint64;
+
+typedef int32		status_t;
+typedef int64		bigtime_t;
+typedef uint32		type_code;
+
+enum {
+	B_OK				= 0,
+	B_ERROR				= -1,
+	B_NO_MEMORY			= -0x7fff0000,
+	B_IO_ERROR,
+	B_BAD_VALUE,
+	B_BAD_DATA,
+	B_NO_INIT,
+	B_BUSY,
+	B_ENTRY_NOT_FOUND
+};
+
+#define B_RAW_TYPE			'RAWT'
+
+#define min_c(a, b)			((a) > (b) ? (b) : (a))
+#define max_c(a, b)			((a) > (b) ? (a) : (b))
+
+#endif // _SUPPORT_DEFS_H
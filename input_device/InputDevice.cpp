@@ -11,6 +11,7 @@
  */
 
 #include "InputDevice.h"
+#include "PasteProtocol.h"
 
 #include <InterfaceDefs.h>
 
@@ -109,43 +110,77 @@ ClipdingerInputDevice::Control(const char* device, void* cookie,
 }
 
 
+static BMessage*
+key_event(uint32 what, char key, int32 modifiers)
+{
+	char bytes[2] = { key, 0 };
+
+	BMessage* event = new BMessage(what);
+	event->AddInt64("when", system_time());
+	event->AddInt32("raw_char", key);
+	event->AddInt32("modifiers", modifiers);
+	event->AddInt8("byte", key);
+	event->AddInt8("byte", 0);
+	event->AddInt8("byte", 0);
+	event->AddInt32("raw_char", key);
+	event->AddString("bytes", bytes);
+	return event;
+}
+
+
 int32
 ClipdingerInputDevice::listener(void* arg)
 {
-	port_id port = create_port(20, "Clipdinger output port");
+	port_id port = create_port(20, OUTPUT_PORT_NAME);
 
 	ClipdingerInputDevice* clipdingerDevice = (ClipdingerInputDevice *)arg;
-	
+
+	// after a paste it rests as long as the request asks for, not a
+	// fixed time
 	int32 code;
-	while (read_port(port, &code, NULL, 0) == B_OK) {
-
-		BMessage* event = new BMessage(B_KEY_DOWN);
-		event->AddInt64("when", system_time());
-		event->AddInt32("raw_char", 118);
-		event->AddInt32("modifiers", B_COMMAND_KEY);
-		event->AddInt8("byte", 'v');
-		event->AddInt8("byte", 0);
-		event->AddInt8("byte", 0);
-		event->AddInt32("raw_char", 'v');
-		event->AddString("bytes", "v");
-		
-		clipdingerDevice->EnqueueMessage(event);
-
-		event = new BMessage(B_KEY_UP);
-		event->AddInt64("when", system_time());
-		event->AddInt32("raw_char", 118);
-		event->AddInt32("modifiers", B_COMMAND_KEY);
-		event->AddInt8("byte", 'v');
-		event->AddInt8("byte", 0);
-		event->AddInt8("byte", 0);
-		event->AddInt32("raw_char", 'v');
-		event->AddString("bytes", "v");
-		
-		clipdingerDevice->EnqueueMessage(event);
+	paste_request request;
+	ssize_t size;
+	while ((size = read_port(port, &code, &request, sizeof(request))) >= 0) {
+		if (code != kPasteRequest)
+			continue;
+
+		bool handshake = size == sizeof(request);
+		bigtime_t injected;
+		bigtime_t waited = 0;
+		if (handshake && request.key != 0) {
+			// a single key, it doesn't touch the clipboard
+			clipdingerDevice->EnqueueMessage(key_event(B_KEY_DOWN,
+				request.key, 0));
+			clipdingerDevice->EnqueueMessage(key_event(B_KEY_UP,
+				request.key, 0));
+			injected = system_time();
+		} else {
+			clipdingerDevice->EnqueueMessage(key_event(B_KEY_DOWN, 'v',
+				B_COMMAND_KEY));
+			clipdingerDevice->EnqueueMessage(key_event(B_KEY_UP, 'v',
+				B_COMMAND_KEY));
+			injected = system_time();
+
+			// the target takes the clip from the clipboard some time after
+			// the keys, it's only answered when it had the gap for that
+			if (handshake && request.gap > 0) {
+				snooze(request.gap);
+				waited = system_time() - injected;
+			}
+		}
 
 //	syslog(LOG_INFO, "Clipdinger device: Added event");
-	
-		snooze(100000);
+
+		if (handshake && request.replyPort >= 0) {
+			paste_ack ack;
+			ack.sequence = request.sequence;
+			ack.requested = request.requested;
+			ack.injected = injected;
+			ack.waited = waited;
+			// never wait on Clipdinger, it may be gone
+			write_port_etc(request.replyPort, kPasteDone, &ack, sizeof(ack),
+				B_RELATIVE_TIMEOUT, 0);
+		}
 	}
 
 	delete_port(port);
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2015-2016. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Author:
+ *	Humdinger, humdingerb@gmail.com
+ */
+
+#ifndef PASTE_PROTOCOL_H
+#define PASTE_PROTOCOL_H
+
+#include <OS.h>
+
+// How Clipdinger asks its input device for a paste. It writes a
+// kPasteRequest with a paste_request to the device's port, the device
+// injects a Cmd+V and answers with a kPasteDone and a paste_ack with the
+// same sequence number to the reply port of the request.
+// Instead of a paste, a request may also ask for a single key, like the
+// tab between the clips of a paste sequence.
+// The gap is how long after a paste the device waits before it answers,
+// the target has that long to take the clip from the clipboard. Pastes
+// are thus never closer together than the gap, as the device handles
+// one request after the other. Requests without data, from older
+// versions, are pasted right away and aren't answered.
+
+#define OUTPUT_PORT_NAME	"Clipdinger output port"
+
+enum {
+	kPasteRequest	= 'CtSV',
+	kPasteDone		= 'CtSD'
+};
+
+struct paste_request {
+	int32			sequence;
+	port_id			replyPort;
+	bigtime_t		requested;	// system_time() when it was sent
+	bigtime_t		gap;
+	int32			key;		// 0 for Cmd+V
+};
+
+struct paste_ack {
+	int32			sequence;
+	bigtime_t		requested;
+	bigtime_t		injected;	// when the key events were enqueued
+	bigtime_t		waited;		// after that, time spent keeping the gap
+};
+
+#endif // PASTE_PROTOCOL_H